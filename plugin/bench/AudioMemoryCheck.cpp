@@ -0,0 +1,65 @@
+// The prefault path prepareAudioMemory relies on: a zeroed, prefaulted
+// buffer must take no page faults when a block reads and writes it, while
+// touching fresh pages must show up in the counter (so zero means zero).
+// Exits non-zero if either fails.
+#include "AudioMemory.h"
+#include "LookaheadDelay.h"
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+// One store per page of memory nothing has written yet
+long faultsTouchingFreshPages(size_t bytes) {
+    void* fresh = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (fresh == MAP_FAILED) {
+        return -1;
+    }
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const long before = AudioMemory::pageFaults();
+    for (size_t offset = 0; offset < bytes; offset += page) {
+        static_cast<volatile char*>(fresh)[offset] = 1;
+    }
+    const long faults = AudioMemory::pageFaults() - before;
+    munmap(fresh, bytes);
+    return faults;
+}
+
+}
+
+int main() {
+    constexpr size_t bytes = 4 << 20;
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 512;
+
+    const long freshFaults = faultsTouchingFreshPages(bytes);
+    std::printf("Fresh %zu KB: %ld page faults\n", bytes / 1024, freshFaults);
+
+    // A delay line and a block buffer set up the way the processor does it
+    LookaheadDelay delay;
+    delay.prepare(numChannels, 48000);
+    double block[numChannels][blockSize] = {};
+    double* channels[numChannels] = {block[0], block[1]};
+
+    AudioMemory::Visitor prefault = [](const void* data, size_t size) {
+        AudioMemory::prefault({data, size});
+    };
+    delay.visitMemory(prefault);
+    prefault(block, sizeof(block));
+
+    // Enough blocks to wrap the delay line twice
+    const long before = AudioMemory::pageFaults();
+    for (int i = 0; i < 2 * 48000 / blockSize + 1; i++) {
+        delay.process(channels, numChannels, blockSize);
+    }
+    const long blockFaults = AudioMemory::pageFaults() - before;
+    std::printf("Prefaulted blocks: %ld page faults\n", blockFaults);
+
+    const bool passed = freshFaults > 0 && blockFaults == 0;
+    if (!passed) {
+        std::printf("FAILED\n");
+    }
+    return passed ? 0 : 1;
+}
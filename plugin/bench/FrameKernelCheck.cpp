@@ -0,0 +1,59 @@
+// YUV 4:2:0 conversion as publishFrame runs it (row-pair bands on the
+// task pool) against the scalar BT.709 reference in FrameKernels. Frames
+// cover the common checkpoint size and odd sizes, with values slightly
+// past [-1, 1] to reach the clamps. Exits non-zero if any layout is off
+// by more than the half code value its rounding allows.
+#include "FrameKernels.h"
+#include "AccuracyMetrics.h"
+#include "TaskPool.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int main() {
+    constexpr AccuracyMetrics::Thresholds thresholds{55.0, 0.0, 0.5 + 1e-3};
+    constexpr int sizes[][2] = {{512, 512}, {64, 48}, {33, 17}, {7, 3}, {1, 1}};
+    constexpr int grains[] = {16, 1};
+
+    TaskPool pool;
+    pool.start(4);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> uniform(-1.1f, 1.1f);
+
+    bool allPassed = true;
+    for (const auto& size : sizes) {
+        const int width = size[0];
+        const int height = size[1];
+        std::vector<float> frame(static_cast<size_t>(width) * height * Constants::frameNumCh);
+        for (auto& value : frame) {
+            value = uniform(rng);
+        }
+
+        const size_t bytes = FrameKernels::getYuv420Bytes(width, height);
+        std::vector<uint8_t> yuv(bytes);
+        std::vector<float> converted(bytes);
+        std::vector<double> reference(bytes);
+        for (YuvLayout layout : {YuvLayout::Nv12, YuvLayout::I420}) {
+            FrameKernels::referenceYuv420(frame.data(), reference.data(), width, height, layout);
+            for (int grain : grains) {
+                // Poison the output so a band the pool skipped shows up
+                std::fill(yuv.begin(), yuv.end(), uint8_t{0xAA});
+                pool.parallelFor(FrameKernels::getYuv420RowPairs(height), grain, [&](int begin, int end) {
+                    FrameKernels::planarToYuv420(frame.data(), yuv.data(), width, height, layout, begin, end);
+                });
+                std::copy(yuv.begin(), yuv.end(), converted.begin());
+
+                const auto report = AccuracyMetrics::compareSignals(converted.data(), reference.data(), bytes, 255.0);
+                const bool passed = AccuracyMetrics::passes(report, thresholds);
+                allPassed = allPassed && passed;
+                std::printf("%s %dx%d, grain %d: PSNR %.2f dB, max error %.4f%s\n",
+                            layout == YuvLayout::Nv12 ? "NV12" : "I420", width, height, grain,
+                            report.psnr, report.maxError, passed ? "" : " (FAILED)");
+            }
+        }
+    }
+
+    pool.stop();
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+// Contention between the renderer's writer threads with the shared state
+// packed together (the original layout) and partitioned into one
+// cache-line block per writer (GuiState, InferenceState, WorkerState,
+// AudioState in autolume.h). Each thread stores to its own fields in a
+// tight loop and reads one field another thread owns, like the real loops.
+#include "defines.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int iterations = 20'000'000;
+    constexpr int repeats = 5;
+
+    // Every field next to the others, in declaration order
+    struct Packed {
+        std::atomic<float> latentSpeed{0.25f};
+        std::atomic<uint32_t> inferenceRequestSeq{0};
+        std::atomic<float> latentX{0.0f};
+        std::atomic<uint32_t> inferenceServedSeq{0};
+        std::atomic<float> analysisCostMicros{0.0f};
+        std::atomic<int> framesInFlight{0};
+        std::atomic<float> primaryCostMicros{0.0f};
+        int rp = 0;
+        int cnt = 0;
+    };
+
+    // One block per writer, each on its own line
+    struct Partitioned {
+        struct alignas(Constants::cacheLineSize) {
+            std::atomic<float> latentSpeed{0.25f};
+            std::atomic<uint32_t> inferenceRequestSeq{0};
+        } gui;
+        struct alignas(Constants::cacheLineSize) {
+            std::atomic<float> latentX{0.0f};
+            std::atomic<uint32_t> inferenceServedSeq{0};
+            std::atomic<float> analysisCostMicros{0.0f};
+        } infer;
+        struct alignas(Constants::cacheLineSize) {
+            std::atomic<int> framesInFlight{0};
+            std::atomic<float> primaryCostMicros{0.0f};
+        } work;
+        struct alignas(Constants::cacheLineSize) {
+            int rp = 0;
+            int cnt = 0;
+        } audio;
+    };
+
+    // Field access by writer, so both layouts run the same loops
+    struct PackedFields {
+        Packed& s;
+        auto& latentSpeed() { return s.latentSpeed; }
+        auto& inferenceRequestSeq() { return s.inferenceRequestSeq; }
+        auto& latentX() { return s.latentX; }
+        auto& inferenceServedSeq() { return s.inferenceServedSeq; }
+        auto& analysisCostMicros() { return s.analysisCostMicros; }
+        auto& framesInFlight() { return s.framesInFlight; }
+        auto& primaryCostMicros() { return s.primaryCostMicros; }
+        int& rp() { return s.rp; }
+        int& cnt() { return s.cnt; }
+    };
+
+    struct PartitionedFields {
+        Partitioned& s;
+        auto& latentSpeed() { return s.gui.latentSpeed; }
+        auto& inferenceRequestSeq() { return s.gui.inferenceRequestSeq; }
+        auto& latentX() { return s.infer.latentX; }
+        auto& inferenceServedSeq() { return s.infer.inferenceServedSeq; }
+        auto& analysisCostMicros() { return s.infer.analysisCostMicros; }
+        auto& framesInFlight() { return s.work.framesInFlight; }
+        auto& primaryCostMicros() { return s.work.primaryCostMicros; }
+        int& rp() { return s.audio.rp; }
+        int& cnt() { return s.audio.cnt; }
+    };
+
+    // Nanoseconds per iteration of the slowest thread
+    template <typename Fields>
+    double run(Fields fields) {
+        using namespace std::chrono;
+        std::atomic<int> ready{0};
+        std::atomic<bool> go{false};
+        std::vector<double> seconds(4);
+        std::vector<std::thread> threads;
+
+        auto timed = [&](int index, auto&& body) {
+            threads.emplace_back([&, index, body]() mutable {
+                ready.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) {
+                }
+                auto start = steady_clock::now();
+                for (int i = 0; i < iterations; i++) {
+                    body(i);
+                }
+                seconds[index] = duration<double>(steady_clock::now() - start).count();
+            });
+        };
+
+        // GUI: speed and requests, reads the served sequence
+        timed(0, [fields](int i) mutable {
+            fields.latentSpeed().store(static_cast<float>(i), std::memory_order_relaxed);
+            fields.inferenceRequestSeq().store(static_cast<uint32_t>(i), std::memory_order_release);
+            (void) fields.inferenceServedSeq().load(std::memory_order_acquire);
+        });
+        // Inference: latent walk, served sequence and cost, reads the requests
+        timed(1, [fields](int i) mutable {
+            (void) fields.inferenceRequestSeq().load(std::memory_order_acquire);
+            fields.latentX().store(static_cast<float>(i), std::memory_order_relaxed);
+            fields.inferenceServedSeq().store(static_cast<uint32_t>(i), std::memory_order_release);
+            fields.analysisCostMicros().store(static_cast<float>(i), std::memory_order_relaxed);
+        });
+        // Worker: publish count and forward cost
+        timed(2, [fields](int i) mutable {
+            fields.framesInFlight().fetch_sub(1, std::memory_order_acq_rel);
+            fields.primaryCostMicros().store(static_cast<float>(i), std::memory_order_relaxed);
+        });
+        // Audio: ring position, plain stores the compiler must keep
+        timed(3, [fields](int i) mutable {
+            volatile int* rp = &fields.rp();
+            volatile int* cnt = &fields.cnt();
+            *rp = i & 8191;
+            *cnt = *cnt + 1;
+        });
+
+        while (ready.load() < 4) {
+        }
+        go.store(true, std::memory_order_release);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return *std::max_element(seconds.begin(), seconds.end()) * 1.0e9 / iterations;
+    }
+}
+
+int main() {
+    double packed = 1.0e30;
+    double partitioned = 1.0e30;
+    for (int r = 0; r < repeats; r++) {
+        Packed packedState;
+        Partitioned partitionedState;
+        packed = std::min(packed, run(PackedFields{packedState}));
+        partitioned = std::min(partitioned, run(PartitionedFields{partitionedState}));
+    }
+
+    std::printf("State layout, 4 writer threads, %d iterations (best of %d)\n", iterations, repeats);
+    std::printf("  packed:      %6.2f ns/iteration\n", packed);
+    std::printf("  partitioned: %6.2f ns/iteration\n", partitioned);
+    std::printf("  speedup:     %6.2fx\n", packed / partitioned);
+    if (std::thread::hardware_concurrency() < 4) {
+        std::printf("Fewer cores than writers: the threads take turns, so the layouts can't contend\n");
+    }
+    return 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <torch/torch.h>
+#include <torch/script.h>
+#include <functional>
+#include <vector>
+
+/**
+ * ModelPreparation - Optional load-time rewrites of the TorchScript module
+ *
+ * Each rewrite is checked against the untouched module before it is kept:
+ * the caller renders a reference set, applies the rewrite, and compares
+ * quality (AccuracyMetrics) and throughput (measureFps).
+ */
+namespace ModelPreparation
+{
+    // Forwards per second over iterations runs (after a short warm-up that
+    // lets the profiling executor specialise and fuse the graph)
+    double measureFps(const std::function<torch::Tensor()>& forward, int iterations);
+    double measureFps(torch::jit::script::Module& model, std::vector<torch::jit::IValue>& inputs, int iterations);
+
+    // Re-lay every 4-D parameter and buffer (conv weights, constant noise)
+    // in the given format. Convolutions follow the weight layout, so the
+    // whole conv path runs NHWC after a ChannelsLast conversion.
+    void setConvMemoryFormat(torch::jit::script::Module& model, torch::MemoryFormat format);
+
+    // oneDNN Graph fusion of the profiled CPU graph (x86 builds only);
+    // returns whether fusion is available
+    bool setOneDnnFusion(bool enabled);
+}
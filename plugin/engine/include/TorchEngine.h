@@ -0,0 +1,154 @@
+#pragma once
+
+#include "InferenceEngine.h"
+#include <torch/torch.h>
+#include <torch/script.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+#include <torch/csrc/inductor/aoti_package/model_package_loader.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * TorchEngine - libtorch implementation of InferenceEngine
+ *
+ * Owns the TorchScript module (or AOTInductor package), the device, the
+ * load-time rewrites (precomputed noise, channels_last, Static Runtime)
+ * and one render slot per frame worker. Created through
+ * autolumeCreateEngine() in the engine library.
+ */
+class TorchEngine : public InferenceEngine
+{
+public:
+    ~TorchEngine() override;
+
+    bool loadModel(const std::string& path, const PipelineConfig& config) override;
+    bool getProjectionBasis(std::vector<float>& basis, int& latentDim, int& numFeatures) const override;
+    bool initializeDevice(int& width, int& height) override;
+    int prepareSlots(int requested) override;
+    void shareThreads(int numWorkers) override;
+    const float* render(int slot, uint64_t seq, const float* input, float seedX, float seedY) override;
+    void setNoiseStrength(float value) override;
+    float getNoiseStrength() const override;
+    bool canSetNoiseStrength() const override { return noiseAdjustable.load(std::memory_order_acquire); }
+    void getMemoryUsage(EngineMemoryUsage& usage) const override;
+
+private:
+    // Find and cache noise_strength parameters from model
+    void findNoiseStrengthParameters();
+    // Load <model>.basis.pt if present, switching to latent-input mode
+    void loadProjectionBasis(const std::string& path);
+    // Switch the synthesis layers to precomputed noise (after the module
+    // is on its device); on failure the layers get their checkpoint noise
+    // back and the engine stays on NoiseMode::Random
+    void prepareNoise();
+    // Load frame seq's noise from the bank (cycled mode only)
+    void advanceNoise(uint64_t seq);
+    // Convert the module to channels_last if that keeps outputs within
+    // tolerance, reporting the fps change
+    void applyChannelsLast();
+    // Freeze the module into a Static Runtime, comparing output and fps
+    // with the interpreter; falls back to the interpreter on mismatch
+    void buildStaticRuntime();
+    // Compare a package with the checkpoint it was exported from (<stem>.pt
+    // next to it); on mismatch the checkpoint runs through the interpreter
+    void checkPackage();
+
+    // Noise the reference set and every check render with: the same
+    // fixed-seed draw in each switchable layer's noise_const, or silenced
+    // strengths when the model has no such layers. saved collects what was
+    // replaced as it goes, so a throw midway can still be undone.
+    struct SavedNoise {
+        std::vector<torch::jit::script::Module> layers;
+        std::vector<torch::Tensor> buffers;
+        std::vector<torch::jit::IValue> modes;
+        std::vector<float> strengths;
+    };
+    void useCheckNoise(SavedNoise& saved);
+    // Put back what useCheckNoise replaced (logs instead of throwing)
+    void restoreNoise(const SavedNoise& saved);
+    // Fill slot's input tensors and build the forward arguments
+    struct Slot;
+    std::vector<torch::jit::IValue> buildInputs(Slot& slot, const float* input, float seedX, float seedY);
+    // Fixed inputs every rewrite is compared on, and referenceOutputs:
+    // their renders by the module as loaded, before any rewrite, with the
+    // check noise (packages get theirs from checkPackage)
+    void buildReferenceSet();
+    // CPU [3, H, W] renders through the interpreter (null runtime) or a
+    // Static Runtime
+    std::vector<torch::Tensor> renderReferenceSet(torch::jit::StaticRuntime* runtime);
+    // Render the reference set through the rewritten model (check noise in
+    // place) and keep the rewrite only if PSNR, SSIM and max error against
+    // referenceOutputs stay within thresholds
+    bool acceptRewrite(const char* name, torch::jit::StaticRuntime* runtime, double baselineFps, double fps);
+    // Run the module through the caller's Static Runtime, or the
+    // interpreter when runtime is null
+    torch::Tensor forwardModel(std::vector<torch::jit::IValue>& modelInputs, torch::jit::StaticRuntime* runtime);
+
+    PipelineConfig config;
+    std::string modelPath;
+
+    // Model
+    torch::jit::script::Module model;
+    torch::Device device{torch::kCPU};  // Start with CPU, switch to the best device in initializeDevice()
+    std::vector<torch::jit::IValue> inputs;  // Test and benchmark inputs
+    int frameWidth = 0;
+    int frameHeight = 0;
+
+    // AOTInductor package: compiled kernels plus weights, run instead of
+    // the TorchScript module (which stays empty). It has its own runners,
+    // one per frame worker, and is fixed to the device it was compiled for.
+    std::unique_ptr<torch::inductor::AOTIModelPackageLoader> aotiPackage;
+    bool aotiOnCuda = false;
+
+    // Latent-input models take forward(latent [1, D]) instead of the audio
+    // buffer plus seeds
+    std::vector<float> projectionBasis;
+    int latentDim = 0;
+    int basisFeatures = 0;
+
+    // Static Runtime mode: the module frozen with its current noise
+    // strengths (later setNoiseStrength calls apply from the next load)
+    std::unique_ptr<torch::jit::StaticModule> staticModule;
+
+    // One slot per concurrent caller: input tensors, runtime and output
+    // can't be shared between threads
+    struct Slot {
+        torch::Tensor inputTensor;
+        torch::Tensor latentTensor;
+        std::unique_ptr<torch::jit::StaticRuntime> staticRuntime;
+        torch::Tensor output;  // Keeps the last frame alive for the caller
+    };
+    std::vector<std::unique_ptr<Slot>> slots;
+
+    // Accounting, measured when the parts are built
+    size_t weightBytes = 0;
+    size_t slotBytes = 0;       // Retained per slot: inputs plus the CPU frame
+    size_t noiseBankBytes = 0;
+
+    // Workers this engine counts in the process-wide thread split
+    int threadShare = 0;
+
+    struct ReferenceInput {
+        std::vector<float> input;
+        float seedX = 0.0f;
+        float seedY = 0.0f;
+    };
+    std::vector<ReferenceInput> referenceInputs;
+    std::vector<torch::Tensor> referenceOutputs;
+
+    // Noise strength parameters (cached for real-time control). Static
+    // Runtime freezes them into the graph, which makes them read-only.
+    std::vector<torch::Tensor> noiseStrengthParams;
+    std::atomic<bool> noiseAdjustable{false};
+
+    // Precomputed noise: each layer's noise_const buffer and, when
+    // cycling, the bank copied into it per frame (no RNG on the hot path)
+    struct NoiseLayer {
+        torch::Tensor buffer;
+        std::vector<torch::Tensor> bank;
+    };
+    std::vector<NoiseLayer> noiseLayers;
+    bool noiseCycling = false;
+};
@@ -0,0 +1,57 @@
+#include "ModelPreparation.h"
+#include <chrono>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <torch/csrc/jit/codegen/onednn/interface.h>
+#define AUTOLUME_HAS_ONEDNN_FUSION 1
+#endif
+
+namespace ModelPreparation
+{
+    double measureFps(const std::function<torch::Tensor()>& forward, int iterations) {
+        using namespace std::chrono;
+        torch::NoGradGuard no_grad;
+
+        // Output is read back every run so asynchronous devices are timed too
+        for (int i = 0; i < 3; i++) {
+            forward().to(torch::kCPU);
+        }
+
+        auto start = steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            forward().to(torch::kCPU);
+        }
+        double seconds = duration<double>(steady_clock::now() - start).count();
+        return seconds > 0.0 ? iterations / seconds : 0.0;
+    }
+
+    double measureFps(torch::jit::script::Module& model, std::vector<torch::jit::IValue>& inputs, int iterations) {
+        return measureFps([&] { return model.forward(inputs).toTensor(); }, iterations);
+    }
+
+    void setConvMemoryFormat(torch::jit::script::Module& model, torch::MemoryFormat format) {
+        torch::NoGradGuard no_grad;
+        // The handles share storage with the module, so set_data swaps the
+        // module's tensors in place
+        for (auto param : model.parameters()) {
+            if (param.dim() == 4) {
+                param.set_data(param.contiguous(format));
+            }
+        }
+        for (auto buffer : model.buffers()) {
+            if (buffer.dim() == 4) {
+                buffer.set_data(buffer.contiguous(format));
+            }
+        }
+    }
+
+    bool setOneDnnFusion(bool enabled) {
+#ifdef AUTOLUME_HAS_ONEDNN_FUSION
+        torch::jit::fuser::onednn::setLlgaEnabled(enabled);
+        return true;
+#else
+        (void)enabled;
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,856 @@
+#include "TorchEngine.h"
+#include "ModelPreparation.h"
+#include "AccuracyMetrics.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <ATen/detail/MPSHooksInterface.h>
+
+namespace
+{
+    size_t tensorBytes(const torch::Tensor& tensor) {
+        return tensor.defined() ? tensor.nbytes() : 0;
+    }
+
+    size_t moduleBytes(const torch::jit::script::Module& module) {
+        size_t bytes = 0;
+        for (const auto& parameter : module.parameters()) {
+            bytes += tensorBytes(parameter);
+        }
+        for (const auto& buffer : module.buffers()) {
+            bytes += tensorBytes(buffer);
+        }
+        return bytes;
+    }
+
+    // libtorch has one intra-op pool per process, shared by every engine
+    // of every plugin instance in the host: each engine that runs frame
+    // workers holds a share, and the cores are split over all of them
+    struct ThreadShares {
+        std::mutex mutex;
+        std::map<const void*, int> workers;
+    };
+
+    ThreadShares& threadShares() {
+        static ThreadShares shares;
+        return shares;
+    }
+}
+
+extern "C" __attribute__((visibility("default"))) InferenceEngine* autolumeCreateEngine() {
+    return new TorchEngine();
+}
+
+extern "C" __attribute__((visibility("default"))) void autolumeDestroyEngine(InferenceEngine* engine) {
+    delete engine;
+}
+
+TorchEngine::~TorchEngine() {
+    if (threadShare > 0) {
+        shareThreads(0);
+    }
+}
+
+bool TorchEngine::loadModel(const std::string& path, const PipelineConfig& newConfig) {
+    config = newConfig;
+    modelPath = path;
+
+    // Nothing from the previous model survives a reload: the frozen graph
+    // and the slots' runtimes would keep rendering the old checkpoint
+    for (auto& slot : slots) {
+        slot->staticRuntime.reset();
+    }
+    staticModule.reset();
+    noiseAdjustable.store(false, std::memory_order_release);
+    noiseLayers.clear();
+    noiseCycling = false;
+    noiseBankBytes = 0;
+
+    try {
+        // Load model
+        if (std::filesystem::path(path).extension() == ".pt2") {
+            // Each frame worker needs its own runner inside the package
+            size_t numRunners = static_cast<size_t>(std::max(1, config.inferenceWorkers));
+            aotiPackage = std::make_unique<torch::inductor::AOTIModelPackageLoader>(path, "model", false, numRunners);
+            auto metadata = aotiPackage->get_metadata();
+            aotiOnCuda = metadata["AOTI_DEVICE_KEY"] == "cuda";
+            std::cout << "Autolume: AOTInductor package for " << (aotiOnCuda ? "CUDA" : "CPU") << std::endl;
+
+            // The package stores its constants uncompressed
+            weightBytes = static_cast<size_t>(std::filesystem::file_size(path));
+        } else {
+            aotiPackage.reset();
+            model = torch::jit::load(path);
+            model.eval();
+            weightBytes = moduleBytes(model);
+        }
+
+        // Prepare input tensor (slot 0 serves the inference thread itself)
+        std::cout << "Autolume: Creating input tensor..." << std::endl;
+        slots.clear();
+        slots.push_back(std::make_unique<Slot>());
+        slots[0]->inputTensor = torch::empty({1, config.nfft}, torch::kFloat32);
+        inputs.clear();
+        inputs.emplace_back(slots[0]->inputTensor);
+
+        // A basis next to the checkpoint marks a latent-input model
+        loadProjectionBasis(path);
+
+        // Find and cache noise_strength parameters
+        findNoiseStrengthParameters();
+        noiseAdjustable.store(!noiseStrengthParams.empty(), std::memory_order_release);
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Autolume: ERROR loading model: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void TorchEngine::loadProjectionBasis(const std::string& path) {
+    projectionBasis.clear();
+    latentDim = 0;
+    basisFeatures = 0;
+
+    std::filesystem::path basisPath(path);
+    basisPath.replace_extension(".basis.pt");
+    if (!std::filesystem::exists(basisPath)) {
+        return;
+    }
+
+    // Saved with torch.save(B) on a [latentDim, numFeatures] float tensor
+    std::ifstream file(basisPath, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    auto basis = torch::pickle_load(bytes).toTensor().to(torch::kCPU, torch::kFloat32).contiguous();
+
+    if (basis.dim() != 2 || basis.size(1) > config.nfft) {
+        throw std::runtime_error("projection basis must be [latentDim, numFeatures <= nfft]");
+    }
+
+    latentDim = static_cast<int>(basis.size(0));
+    basisFeatures = static_cast<int>(basis.size(1));
+    const float* data = basis.data_ptr<float>();
+    projectionBasis.assign(data, data + basis.numel());
+
+    slots[0]->latentTensor = torch::zeros({1, latentDim}, torch::kFloat32);
+    inputs.clear();
+    inputs.emplace_back(slots[0]->latentTensor);
+
+    std::cout << "Autolume: Latent-input model, projecting " << basisFeatures
+              << " features to " << latentDim << " latent dims" << std::endl;
+}
+
+bool TorchEngine::getProjectionBasis(std::vector<float>& basis, int& dim, int& numFeatures) const {
+    if (latentDim == 0) {
+        return false;
+    }
+    basis = projectionBasis;
+    dim = latentDim;
+    numFeatures = basisFeatures;
+    return true;
+}
+
+bool TorchEngine::initializeDevice(int& width, int& height) {
+    try {
+        std::cout << "Autolume: Detecting available devices..." << std::endl;
+
+        // Try devices in order of preference: CUDA -> MPS -> CPU
+        bool deviceInitialized = false;
+        std::string deviceName;
+
+        // Try CUDA first (a compiled package only runs where it was compiled for)
+        if (torch::cuda::is_available() && (!aotiPackage || aotiOnCuda)) {
+            try {
+                std::cout << "Autolume: CUDA detected, initializing..." << std::endl;
+                device = torch::Device(torch::kCUDA);
+                deviceName = "CUDA";
+                deviceInitialized = true;
+            } catch (const std::exception& e) {
+                std::cerr << "Autolume: CUDA initialization failed: " << e.what() << std::endl;
+            }
+        }
+
+        // Try MPS if CUDA failed or unavailable
+        if (!deviceInitialized && torch::mps::is_available() && !aotiPackage) {
+            try {
+                std::cout << "Autolume: MPS detected, initializing..." << std::endl;
+                device = torch::Device(torch::kMPS);
+                deviceName = "MPS";
+                deviceInitialized = true;
+            } catch (const std::exception& e) {
+                std::cerr << "Autolume: MPS initialization failed: " << e.what() << std::endl;
+            }
+        }
+
+        // Fall back to CPU
+        if (!deviceInitialized) {
+            std::cout << "Autolume: Falling back to CPU..." << std::endl;
+            device = torch::Device(torch::kCPU);
+            deviceName = "CPU";
+            deviceInitialized = true;
+        }
+
+        std::cout << "Autolume: Using device: " << deviceName << std::endl;
+
+        if (!aotiPackage) {
+            std::cout << "Autolume: Moving model to " << deviceName << "..." << std::endl;
+            model.to(device);
+        }
+
+        std::cout << "Autolume: Moving tensor to " << deviceName << "..." << std::endl;
+        auto& slot = *slots[0];
+        slot.inputTensor = slot.inputTensor.to(device, false, false);
+        inputs.clear();
+        if (latentDim > 0) {
+            slot.latentTensor = slot.latentTensor.to(device, false, false);
+            inputs.emplace_back(slot.latentTensor);
+        } else {
+            inputs.emplace_back(slot.inputTensor);
+        }
+        if (aotiPackage && latentDim == 0) {
+            // Exported programs have no default arguments
+            inputs.emplace_back(torch::tensor(0.0f, device));
+            inputs.emplace_back(torch::tensor(0.0f, device));
+            inputs.emplace_back(torch::tensor(true, device));
+        }
+
+        std::cout << "Autolume: Device initialization complete on " << deviceName << "!" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Autolume: Device initialization failed: " << e.what() << std::endl;
+        return false;
+    }
+
+    // Test forward pass immediately after initialization
+    try {
+        std::cout << "Autolume: Testing forward pass..." << std::endl;
+        torch::NoGradGuard no_grad;
+        auto test_output = forwardModel(inputs, nullptr);
+        std::cout << "Autolume: Test forward pass succeeded! Output shape: ["
+                  << test_output.size(0) << ", " << test_output.size(1) << ", "
+                  << test_output.size(2) << ", " << test_output.size(3) << "]" << std::endl;
+
+        // Frame geometry comes from the checkpoint: [1, 3, H, W]
+        frameHeight = static_cast<int>(test_output.size(2));
+        frameWidth = static_cast<int>(test_output.size(3));
+
+        // Every slot keeps its inputs and the CPU copy of its last frame
+        slotBytes = tensorBytes(slots[0]->inputTensor) + tensorBytes(slots[0]->latentTensor)
+                  + static_cast<size_t>(frameWidth) * frameHeight * Constants::frameNumCh * sizeof(float);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Autolume: Test forward pass FAILED: " << e.what() << std::endl;
+    }
+
+    // Module rewrites don't apply to compiled packages. Each one, and a
+    // package itself, is checked against a reference set rendered before
+    // anything is rewritten.
+    buildReferenceSet();
+    if (aotiPackage) {
+        checkPackage();
+    }
+
+    if (config.noiseMode != NoiseMode::Random && !aotiPackage) {
+        prepareNoise();
+    }
+
+    if (config.channelsLast && !aotiPackage) {
+        applyChannelsLast();
+    }
+
+    if (config.executionMode == ExecutionMode::StaticRuntime && !aotiPackage) {
+        buildStaticRuntime();
+    }
+
+    width = frameWidth;
+    height = frameHeight;
+    return frameWidth > 0 && frameHeight > 0;
+}
+
+int TorchEngine::prepareSlots(int requested) {
+    // A GPU already runs one forward at full occupancy; frame workers
+    // only pay off on many-core CPU nodes
+    if (requested <= 1 || !device.is_cpu()) {
+        return 1;
+    }
+
+    // The pool shrinks to what its budget holds, but slot 0 always exists
+    const size_t slotBudget = config.memoryBudgets.renderSlots;
+    if (slotBudget > 0 && slotBytes > 0) {
+        const int affordable = static_cast<int>(std::max<size_t>(1, slotBudget / slotBytes));
+        if (affordable < requested) {
+            std::cout << "Autolume: Slot budget holds " << affordable << " of " << requested << " render slots" << std::endl;
+            requested = affordable;
+            if (requested == 1) {
+                return 1;
+            }
+        }
+    }
+
+    for (int i = static_cast<int>(slots.size()); i < requested; i++) {
+        auto slot = std::make_unique<Slot>();
+        slot->inputTensor = slots[0]->inputTensor.clone();
+        if (latentDim > 0) {
+            slot->latentTensor = slots[0]->latentTensor.clone();
+        }
+        if (staticModule) {
+            slot->staticRuntime = std::make_unique<torch::jit::StaticRuntime>(*staticModule);
+        }
+        slots.push_back(std::move(slot));
+    }
+
+    std::cout << "Autolume: " << requested << " render slots" << std::endl;
+    return requested;
+}
+
+void TorchEngine::shareThreads(int numWorkers) {
+    auto& shares = threadShares();
+    std::lock_guard<std::mutex> lock(shares.mutex);
+    threadShare = std::max(0, numWorkers);
+    if (threadShare > 0) {
+        shares.workers[this] = threadShare;
+    } else {
+        shares.workers.erase(this);
+    }
+
+    int totalWorkers = 0;
+    for (const auto& share : shares.workers) {
+        totalWorkers += share.second;
+    }
+    if (totalWorkers == 0) {
+        return;
+    }
+
+    // K small forwards scale better than one forward with many intra-op
+    // threads, so each worker in the process gets an equal slice
+    const int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int intraOpThreads = std::max(1, cores / totalWorkers);
+    at::set_num_threads(intraOpThreads);
+    std::cout << "Autolume: " << intraOpThreads << " intra-op threads per worker ("
+              << totalWorkers << " workers in the process)" << std::endl;
+}
+
+const float* TorchEngine::render(int slotIndex, uint64_t seq, const float* input, float seedX, float seedY) {
+    auto& slot = *slots[slotIndex];
+
+    try {
+        torch::NoGradGuard no_grad;
+        torch::Tensor output;
+
+        if (noiseCycling) {
+            advanceNoise(seq);
+        }
+
+        std::vector<torch::jit::IValue> model_inputs = buildInputs(slot, input, seedX, seedY);
+        output = forwardModel(model_inputs, slot.staticRuntime.get());
+
+        // Output is [1, 3, H, W] in range [-1, 1]
+        output = output.squeeze(0).to(torch::kCPU).contiguous();
+        if (output.numel() != static_cast<int64_t>(frameWidth) * frameHeight * Constants::frameNumCh) {
+            throw std::runtime_error("model output does not match the discovered frame size");
+        }
+
+        slot.output = output;
+        return slot.output.data_ptr<float>();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Autolume: Inference error: " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+std::vector<torch::jit::IValue> TorchEngine::buildInputs(Slot& slot, const float* input, float seedX, float seedY) {
+    // from_blob only wraps the caller's buffer; both paths copy out of it
+    float* data = const_cast<float*>(input);
+
+    if (latentDim > 0) {
+        slot.latentTensor.copy_(torch::from_blob(data, {1, latentDim}, torch::kFloat32));
+        return {slot.latentTensor};
+    }
+
+    // Copy CPU buffer to MPS tensor (can't use accessor on MPS tensor)
+    // Create CPU tensor from buffer, then copy to MPS
+    auto cpu_tensor = torch::from_blob(
+        data,
+        {1, config.nfft},
+        torch::kFloat32
+    ).clone();  // Clone to own the data
+
+    // Copy to preallocated MPS tensor
+    slot.inputTensor.copy_(cpu_tensor);
+
+    // Run model inference with seed coordinates (pass as tensors)
+    std::vector<torch::jit::IValue> model_inputs;
+    model_inputs.push_back(slot.inputTensor);
+    model_inputs.push_back(torch::tensor(seedX, device));
+    model_inputs.push_back(torch::tensor(seedY, device));
+    model_inputs.push_back(torch::tensor(true, device));  // Always use seed-based generation
+    return model_inputs;
+}
+
+void TorchEngine::buildReferenceSet() {
+    // Fixed (features, seed) pairs spread over the latent walk
+    constexpr float seeds[][2] = {{0.0f, 0.0f}, {0.5f, 3.25f}, {7.0f, 1.0f}, {12.75f, 4.5f}};
+    const int inputSize = latentDim > 0 ? latentDim : config.nfft;
+
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+
+    referenceInputs.clear();
+    for (const auto& seed : seeds) {
+        ReferenceInput reference;
+        reference.seedX = seed[0];
+        reference.seedY = seed[1];
+        reference.input.resize(inputSize);
+        for (auto& value : reference.input) {
+            // Latents are standard normal; spectra are non-negative
+            value = latentDim > 0 ? normal(rng) : std::abs(normal(rng));
+        }
+        referenceInputs.push_back(std::move(reference));
+    }
+
+    // Rendered once, so the rewrites are each compared with the module as
+    // loaded rather than with the previous rewrite's output
+    referenceOutputs.clear();
+    if (aotiPackage) {
+        return;
+    }
+
+    torch::NoGradGuard no_grad;
+    SavedNoise saved;
+    try {
+        useCheckNoise(saved);
+        if (saved.layers.empty()) {
+            std::cout << "Autolume: Model has no switchable noise layers, checks render it without noise" << std::endl;
+        }
+        referenceOutputs = renderReferenceSet(nullptr);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Autolume: Reference set failed, rewrites will be rejected: " << e.what() << std::endl;
+        referenceOutputs.clear();
+    }
+    restoreNoise(saved);
+}
+
+std::vector<torch::Tensor> TorchEngine::renderReferenceSet(torch::jit::StaticRuntime* runtime) {
+    std::vector<torch::Tensor> outputs;
+    for (const auto& reference : referenceInputs) {
+        auto model_inputs = buildInputs(*slots[0], reference.input.data(), reference.seedX, reference.seedY);
+        outputs.push_back(forwardModel(model_inputs, runtime).squeeze(0).to(torch::kCPU).contiguous());
+    }
+    return outputs;
+}
+
+bool TorchEngine::acceptRewrite(const char* name, torch::jit::StaticRuntime* runtime, double baselineFps, double fps) {
+    // Exact-math rewrites only reorder float32 arithmetic
+    constexpr AccuracyMetrics::Thresholds thresholds{60.0, 0.999, 1e-3};
+    constexpr double outputRange = 2.0;  // [-1, 1]
+
+    if (referenceOutputs.size() != referenceInputs.size()) {
+        std::cerr << "Autolume: " << name << ": no reference set to compare with (rejected)" << std::endl;
+        return false;
+    }
+
+    const int64_t frameValues = static_cast<int64_t>(frameWidth) * frameHeight * Constants::frameNumCh;
+    auto candidate = renderReferenceSet(runtime);
+    AccuracyMetrics::Report report;
+    for (size_t i = 0; i < referenceOutputs.size(); i++) {
+        if (candidate[i].numel() != frameValues || referenceOutputs[i].numel() != frameValues) {
+            std::cerr << "Autolume: " << name << ": output shape differs from the reference (rejected)" << std::endl;
+            return false;
+        }
+        report = AccuracyMetrics::worst(report, AccuracyMetrics::compareImages(
+            candidate[i].data_ptr<float>(), referenceOutputs[i].data_ptr<float>(),
+            frameWidth, frameHeight, Constants::frameNumCh, outputRange));
+    }
+
+    bool accepted = AccuracyMetrics::passes(report, thresholds);
+    std::cout << "Autolume: " << name << ": " << baselineFps << " -> " << fps << " fps, PSNR "
+              << report.psnr << " dB, SSIM " << report.ssim << ", max error " << report.maxError
+              << (accepted ? "" : " (rejected)") << std::endl;
+    return accepted;
+}
+
+torch::Tensor TorchEngine::forwardModel(std::vector<torch::jit::IValue>& modelInputs, torch::jit::StaticRuntime* runtime) {
+    if (aotiPackage) {
+        // Inputs are the preallocated device tensors; the package allocates
+        // its outputs from its own planned buffers
+        std::vector<torch::Tensor> tensors;
+        tensors.reserve(modelInputs.size());
+        for (const auto& value : modelInputs) {
+            tensors.push_back(value.toTensor());
+        }
+        return aotiPackage->run(tensors)[0];
+    }
+    if (runtime) {
+        // Outputs are returned as fresh tensors; only intermediates live in the arena
+        return (*runtime)(modelInputs).toTensor();
+    }
+    return model.forward(modelInputs).toTensor();
+}
+
+void TorchEngine::prepareNoise() {
+    torch::NoGradGuard no_grad;
+    noiseLayers.clear();
+
+    // What each switched layer held before, put back if a step throws
+    struct OriginalNoise {
+        torch::jit::script::Module layer;
+        torch::Tensor buffer;
+        torch::jit::IValue mode;
+    };
+    std::vector<OriginalNoise> originals;
+
+    try {
+        // Synthesis layers keep their noise in a noise_const buffer, one
+        // resolution per layer, and pick the source from noise_mode
+        for (const auto& child : model.named_modules()) {
+            auto layer = child.value;
+            if (!layer.hasattr("noise_const") || !layer.hasattr("noise_mode")) {
+                continue;
+            }
+
+            NoiseLayer noise;
+            noise.buffer = layer.attr("noise_const").toTensor();
+            originals.push_back({layer, noise.buffer.clone(), layer.attr("noise_mode")});
+            noise.buffer.copy_(torch::randn(noise.buffer.sizes(), noise.buffer.options()));
+            layer.setattr("noise_mode", std::string("const"));
+            noiseLayers.push_back(std::move(noise));
+        }
+
+        // Cycling rewrites shared buffers between frames, which concurrent
+        // workers or a frozen graph can't observe consistently
+        noiseCycling = config.noiseMode == NoiseMode::Cycled;
+        if (noiseCycling && (config.inferenceWorkers > 1 || config.executionMode == ExecutionMode::StaticRuntime)) {
+            std::cerr << "Autolume: Noise cycling needs one interpreter worker, using constant noise" << std::endl;
+            noiseCycling = false;
+        }
+
+        // One cycle frame holds a buffer per layer; the budget caps how many
+        // frames the bank keeps, and a bank under two frames is just constant
+        size_t frameBytes = 0;
+        for (const auto& noise : noiseLayers) {
+            frameBytes += tensorBytes(noise.buffer);
+        }
+        int cycleLength = std::max(1, config.noiseCycleLength);
+        const size_t bankBudget = config.memoryBudgets.noiseBank;
+        if (noiseCycling && bankBudget > 0 && frameBytes > 0) {
+            const int affordable = static_cast<int>(std::min<size_t>(bankBudget / frameBytes, static_cast<size_t>(cycleLength)));
+            if (affordable < cycleLength) {
+                std::cout << "Autolume: Noise bank budget holds " << affordable << " of " << cycleLength << " frames" << std::endl;
+                cycleLength = affordable;
+                noiseCycling = cycleLength >= 2;
+            }
+        }
+
+        noiseBankBytes = 0;
+        if (noiseCycling) {
+            noiseBankBytes = frameBytes * cycleLength;
+            for (auto& noise : noiseLayers) {
+                noise.bank.reserve(cycleLength);
+                noise.bank.push_back(noise.buffer.clone());
+                for (int i = 1; i < cycleLength; i++) {
+                    noise.bank.push_back(torch::randn(noise.buffer.sizes(), noise.buffer.options()));
+                }
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Autolume: Precomputed noise failed, keeping random noise: " << e.what() << std::endl;
+        try {
+            for (auto& original : originals) {
+                original.layer.attr("noise_const").toTensor().copy_(original.buffer);
+                original.layer.setattr("noise_mode", original.mode);
+            }
+        }
+        catch (const std::exception& restoreError) {
+            std::cerr << "Autolume: Restoring the checkpoint's noise failed: " << restoreError.what() << std::endl;
+        }
+        noiseLayers.clear();
+        noiseCycling = false;
+        noiseBankBytes = 0;
+        config.noiseMode = NoiseMode::Random;
+        return;
+    }
+
+    if (noiseLayers.empty()) {
+        std::cerr << "Autolume: Model has no switchable noise layers, keeping random noise" << std::endl;
+        noiseCycling = false;
+        return;
+    }
+
+    std::cout << "Autolume: Precomputed " << (noiseCycling ? "cycled" : "constant") << " noise for "
+              << noiseLayers.size() << " layers" << std::endl;
+}
+
+void TorchEngine::getMemoryUsage(EngineMemoryUsage& usage) const {
+    usage.weights = weightBytes;
+    usage.caches = noiseBankBytes;
+    usage.activations = slotBytes * slots.size();
+    usage.allocatorAllocated = 0;
+    usage.allocatorReserved = 0;
+
+    if (device.is_mps()) {
+        const auto& hooks = at::detail::getMPSHooks();
+        usage.allocatorAllocated = hooks.getCurrentAllocatedMemory();
+        usage.allocatorReserved = hooks.getDriverAllocatedMemory();
+    }
+}
+
+void TorchEngine::advanceNoise(uint64_t seq) {
+    torch::NoGradGuard no_grad;
+    for (auto& noise : noiseLayers) {
+        noise.buffer.copy_(noise.bank[seq % noise.bank.size()]);
+    }
+}
+
+void TorchEngine::applyChannelsLast() {
+    constexpr int benchmarkFrames = 20;
+
+    torch::NoGradGuard no_grad;
+    SavedNoise saved;
+
+    try {
+        useCheckNoise(saved);
+        double baselineFps = ModelPreparation::measureFps(model, inputs, benchmarkFrames);
+
+        ModelPreparation::setConvMemoryFormat(model, torch::MemoryFormat::ChannelsLast);
+        bool fused = device.is_cpu() && ModelPreparation::setOneDnnFusion(true);
+
+        // measureFps warms up first, so the fused graph is in place before comparing
+        double convertedFps = ModelPreparation::measureFps(model, inputs, benchmarkFrames);
+        if (!acceptRewrite(fused ? "channels_last + oneDNN fusion" : "channels_last",
+                           nullptr, baselineFps, convertedFps)) {
+            std::cerr << "Autolume: channels_last output mismatch, reverting to contiguous" << std::endl;
+            ModelPreparation::setConvMemoryFormat(model, torch::MemoryFormat::Contiguous);
+            ModelPreparation::setOneDnnFusion(false);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Autolume: channels_last conversion failed: " << e.what() << std::endl;
+        ModelPreparation::setConvMemoryFormat(model, torch::MemoryFormat::Contiguous);
+        ModelPreparation::setOneDnnFusion(false);
+    }
+
+    restoreNoise(saved);
+}
+
+void TorchEngine::buildStaticRuntime() {
+    constexpr int benchmarkFrames = 20;
+
+    if (!device.is_cpu()) {
+        std::cerr << "Autolume: Static Runtime is CPU only, keeping the interpreter" << std::endl;
+        return;
+    }
+
+    torch::NoGradGuard no_grad;
+    SavedNoise saved;
+
+    torch::jit::StaticModuleOptions options;
+    options.enable_out_variant = true;
+    options.optimize_memory = true;
+
+    auto& slot = *slots[0];
+    try {
+        useCheckNoise(saved);
+        double interpreterFps = ModelPreparation::measureFps(model, inputs, benchmarkFrames);
+
+        // Freezing copies the module, so the interpreter path is untouched
+        staticModule = std::make_unique<torch::jit::StaticModule>(model, false, options);
+        slot.staticRuntime = std::make_unique<torch::jit::StaticRuntime>(*staticModule);
+        double staticFps = ModelPreparation::measureFps(
+            [&] { return forwardModel(inputs, slot.staticRuntime.get()); }, benchmarkFrames);
+
+        if (!acceptRewrite("Static Runtime (interpreter -> static)", slot.staticRuntime.get(),
+                           interpreterFps, staticFps)) {
+            throw std::runtime_error("output mismatch");
+        }
+
+        // The comparison module was frozen with the check noise; refreeze
+        // with the live noise and strengths
+        restoreNoise(saved);
+        slot.staticRuntime.reset();
+        staticModule = std::make_unique<torch::jit::StaticModule>(model, false, options);
+        slot.staticRuntime = std::make_unique<torch::jit::StaticRuntime>(*staticModule);
+        noiseAdjustable.store(false, std::memory_order_release);
+        std::cout << "Autolume: Noise strength is frozen into the Static Runtime graph" << std::endl;
+        return;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Autolume: Static Runtime unavailable, keeping the interpreter: " << e.what() << std::endl;
+    }
+
+    slot.staticRuntime.reset();
+    staticModule.reset();
+    restoreNoise(saved);
+}
+
+void TorchEngine::checkPackage() {
+    constexpr int benchmarkFrames = 20;
+
+    // A package draws its noise internally, so it is compared with its
+    // checkpoint rendering that checkpoint's own noise_const; only a
+    // package exported in constant noise mode can match
+    std::filesystem::path checkpointPath(modelPath);
+    checkpointPath.replace_extension(".pt");
+    if (!std::filesystem::exists(checkpointPath)) {
+        std::cerr << "Autolume: No " << checkpointPath.filename().string()
+                  << " next to the package, its output can't be checked" << std::endl;
+        return;
+    }
+
+    torch::NoGradGuard no_grad;
+    auto package = std::move(aotiPackage);
+    try {
+        // Without the package, forwardModel runs the checkpoint; the
+        // package's extra inputs are the forward's defaults spelled out
+        model = torch::jit::load(checkpointPath.string(), device);
+        model.eval();
+        for (const auto& child : model.named_modules()) {
+            auto layer = child.value;
+            if (layer.hasattr("noise_const") && layer.hasattr("noise_mode")) {
+                layer.setattr("noise_mode", std::string("const"));
+            }
+        }
+        referenceOutputs = renderReferenceSet(nullptr);
+        double checkpointFps = ModelPreparation::measureFps(model, inputs, benchmarkFrames);
+
+        aotiPackage = std::move(package);
+        double packageFps = ModelPreparation::measureFps([&] { return forwardModel(inputs, nullptr); }, benchmarkFrames);
+        if (acceptRewrite("AOTInductor package (checkpoint -> package)", nullptr, checkpointFps, packageFps)) {
+            model = torch::jit::script::Module();
+            referenceOutputs.clear();
+            return;
+        }
+
+        // Reloaded so its noise modes are the checkpoint's again
+        std::cerr << "Autolume: Package output mismatch, running " << checkpointPath.filename().string()
+                  << " through the interpreter" << std::endl;
+        auto checkpoint = torch::jit::load(checkpointPath.string(), device);
+        checkpoint.eval();
+        aotiPackage.reset();
+        model = checkpoint;
+        weightBytes = moduleBytes(model);
+        inputs.resize(1);
+        findNoiseStrengthParameters();
+        noiseAdjustable.store(!noiseStrengthParams.empty(), std::memory_order_release);
+
+        // The module rewrites that follow compare with the checkpoint
+        buildReferenceSet();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Autolume: Package check failed, keeping it unchecked: " << e.what() << std::endl;
+        if (package) {
+            aotiPackage = std::move(package);
+        }
+        model = torch::jit::script::Module();
+        referenceOutputs.clear();
+    }
+}
+
+void TorchEngine::useCheckNoise(SavedNoise& saved) {
+    torch::NoGradGuard no_grad;
+
+    // The same draw on every call, layer by layer in module order
+    std::mt19937 rng(4321);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::vector<float> draw;
+    for (const auto& child : model.named_modules()) {
+        auto layer = child.value;
+        if (!layer.hasattr("noise_const") || !layer.hasattr("noise_mode")) {
+            continue;
+        }
+
+        // Filled in place, so precomputed noise keeps its buffers and a
+        // channels_last conversion still reaches them
+        auto buffer = layer.attr("noise_const").toTensor();
+        draw.resize(static_cast<size_t>(buffer.numel()));
+        for (auto& value : draw) {
+            value = normal(rng);
+        }
+        saved.layers.push_back(layer);
+        saved.buffers.push_back(buffer.clone());
+        saved.modes.push_back(layer.attr("noise_mode"));
+        buffer.copy_(torch::from_blob(draw.data(), buffer.sizes(), torch::kFloat32));
+        layer.setattr("noise_mode", std::string("const"));
+    }
+
+    // Random noise is never reproducible, so without switchable layers the
+    // checks run without noise
+    if (saved.layers.empty()) {
+        for (auto& param : noiseStrengthParams) {
+            saved.strengths.push_back(param.item<float>());
+            param.fill_(0.0f);
+        }
+    }
+
+    // Benchmarks read slot 0's input, which starts uninitialised
+    slots[0]->inputTensor.zero_();
+}
+
+void TorchEngine::restoreNoise(const SavedNoise& saved) {
+    torch::NoGradGuard no_grad;
+    try {
+        for (size_t i = 0; i < saved.layers.size(); i++) {
+            auto layer = saved.layers[i];
+            layer.attr("noise_const").toTensor().copy_(saved.buffers[i]);
+            layer.setattr("noise_mode", saved.modes[i]);
+        }
+        for (size_t i = 0; i < noiseStrengthParams.size() && i < saved.strengths.size(); i++) {
+            noiseStrengthParams[i].fill_(saved.strengths[i]);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Autolume: Restoring noise after a check failed: " << e.what() << std::endl;
+    }
+}
+
+void TorchEngine::findNoiseStrengthParameters() {
+    // Find all parameters with "noise_strength" in their name
+    noiseStrengthParams.clear();
+
+    // Compiled packages keep their weights private
+    if (aotiPackage) {
+        return;
+    }
+
+    for (const auto& param : model.named_parameters()) {
+        if (param.name.find("noise_strength") != std::string::npos) {
+            noiseStrengthParams.push_back(param.value);
+            std::cout << "Autolume: Found noise_strength parameter: " << param.name << std::endl;
+        }
+    }
+
+    std::cout << "Autolume: Cached " << noiseStrengthParams.size()
+              << " noise_strength parameters" << std::endl;
+}
+
+void TorchEngine::setNoiseStrength(float value) {
+    if (!noiseAdjustable.load(std::memory_order_acquire)) {
+        std::cerr << "Autolume: Noise strength can't be changed for this model" << std::endl;
+        return;
+    }
+
+    // Set all noise_strength parameters to the given value
+    // Thread-safe: PyTorch tensor operations are thread-safe
+    torch::NoGradGuard no_grad;
+
+    for (auto& param : noiseStrengthParams) {
+        param.fill_(value);
+    }
+}
+
+float TorchEngine::getNoiseStrength() const {
+    // Return the value of the first noise_strength parameter
+    if (noiseStrengthParams.empty()) {
+        return 0.0f;
+    }
+
+    return noiseStrengthParams[0].item<float>();
+}
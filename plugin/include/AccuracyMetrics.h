@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+/**
+ * AccuracyMetrics - Quality of an optimised path against its reference
+ *
+ * Used by the engine to accept or reject load-time model rewrites and by
+ * the feature self-check. Images are planar [C, H, W]; signals are flat.
+ * The reference may be float32 (model) or double (feature extraction).
+ */
+namespace AccuracyMetrics
+{
+    struct Report {
+        double psnr = std::numeric_limits<double>::infinity();  // dB, relative to the value range
+        double ssim = 1.0;                                      // Mean over 8x8 windows (images only)
+        double maxError = 0.0;                                  // Largest absolute difference
+    };
+
+    struct Thresholds {
+        double minPsnr;
+        double minSsim;
+        double maxError;
+    };
+
+    inline bool passes(const Report& report, const Thresholds& limits) {
+        return report.psnr >= limits.minPsnr && report.ssim >= limits.minSsim && report.maxError <= limits.maxError;
+    }
+
+    // Keep the worst of two reports (a set of inputs passes only if every one does)
+    inline Report worst(const Report& a, const Report& b) {
+        return {std::min(a.psnr, b.psnr), std::min(a.ssim, b.ssim), std::max(a.maxError, b.maxError)};
+    }
+
+    template <typename Reference>
+    Report compareSignals(const float* test, const Reference* reference, size_t count, double range) {
+        Report report;
+        double squaredError = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            double error = static_cast<double>(test[i]) - static_cast<double>(reference[i]);
+            squaredError += error * error;
+            report.maxError = std::max(report.maxError, std::abs(error));
+        }
+
+        // NaNs must fail every threshold, so don't let comparisons skip them
+        if (!(squaredError == squaredError)) {
+            report.psnr = -std::numeric_limits<double>::infinity();
+            report.maxError = std::numeric_limits<double>::infinity();
+        } else if (squaredError > 0.0 && count > 0) {
+            report.psnr = 10.0 * std::log10(range * range / (squaredError / static_cast<double>(count)));
+        }
+        return report;
+    }
+
+    // Structural similarity over non-overlapping 8x8 windows of each plane
+    inline double ssim(const float* test, const float* reference, int width, int height, int channels, double range) {
+        constexpr int window = 8;
+        const double c1 = (0.01 * range) * (0.01 * range);
+        const double c2 = (0.03 * range) * (0.03 * range);
+        const size_t planeSize = static_cast<size_t>(width) * height;
+
+        double total = 0.0;
+        int windows = 0;
+        for (int c = 0; c < channels; c++) {
+            const float* a = test + c * planeSize;
+            const float* b = reference + c * planeSize;
+            for (int y0 = 0; y0 + window <= height; y0 += window) {
+                for (int x0 = 0; x0 + window <= width; x0 += window) {
+                    double meanA = 0.0, meanB = 0.0;
+                    for (int y = y0; y < y0 + window; y++) {
+                        for (int x = x0; x < x0 + window; x++) {
+                            meanA += a[static_cast<size_t>(y) * width + x];
+                            meanB += b[static_cast<size_t>(y) * width + x];
+                        }
+                    }
+                    meanA /= window * window;
+                    meanB /= window * window;
+
+                    double varA = 0.0, varB = 0.0, covariance = 0.0;
+                    for (int y = y0; y < y0 + window; y++) {
+                        for (int x = x0; x < x0 + window; x++) {
+                            double da = a[static_cast<size_t>(y) * width + x] - meanA;
+                            double db = b[static_cast<size_t>(y) * width + x] - meanB;
+                            varA += da * da;
+                            varB += db * db;
+                            covariance += da * db;
+                        }
+                    }
+                    varA /= window * window - 1;
+                    varB /= window * window - 1;
+                    covariance /= window * window - 1;
+
+                    total += ((2.0 * meanA * meanB + c1) * (2.0 * covariance + c2))
+                           / ((meanA * meanA + meanB * meanB + c1) * (varA + varB + c2));
+                    windows++;
+                }
+            }
+        }
+        return windows > 0 ? total / windows : 1.0;
+    }
+
+    inline Report compareImages(const float* test, const float* reference, int width, int height, int channels, double range) {
+        Report report = compareSignals(test, reference, static_cast<size_t>(width) * height * channels, range);
+        report.ssim = ssim(test, reference, width, height, channels, range);
+        return report;
+    }
+}
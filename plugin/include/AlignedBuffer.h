@@ -0,0 +1,83 @@
+#pragma once
+
+#include "defines.h"
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+
+/**
+ * AlignedBuffer - Heap array aligned to a cache line
+ *
+ * Replaces fixed-size std::array members whose size is only known at
+ * runtime. Storage is allocated once by allocate() and zero-filled; it is
+ * never resized implicitly, so pointers stay valid until the next
+ * allocate() or destruction.
+ */
+template <typename T>
+class AlignedBuffer
+{
+public:
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(size_t count) { allocate(count); }
+    ~AlignedBuffer() { release(); }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    AlignedBuffer(AlignedBuffer&& other) noexcept
+        : ptr(std::exchange(other.ptr, nullptr)), count(std::exchange(other.count, 0)) {}
+
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            ptr = std::exchange(other.ptr, nullptr);
+            count = std::exchange(other.count, 0);
+        }
+        return *this;
+    }
+
+    /**
+     * Allocate storage for count elements (previous contents are discarded)
+     */
+    void allocate(size_t newCount) {
+        release();
+        if (newCount == 0) {
+            return;
+        }
+        ptr = static_cast<T*>(::operator new(newCount * sizeof(T), std::align_val_t{Constants::cacheLineSize}));
+        count = newCount;
+        std::memset(static_cast<void*>(ptr), 0, count * sizeof(T));
+    }
+
+    void fill(const T& value) {
+        for (size_t i = 0; i < count; i++) {
+            ptr[i] = value;
+        }
+    }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+    size_t size() const { return count; }
+    size_t sizeInBytes() const { return count * sizeof(T); }
+
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+
+    T* begin() { return ptr; }
+    T* end() { return ptr + count; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+
+private:
+    void release() {
+        if (ptr != nullptr) {
+            ::operator delete(static_cast<void*>(ptr), std::align_val_t{Constants::cacheLineSize});
+            ptr = nullptr;
+            count = 0;
+        }
+    }
+
+    T* ptr = nullptr;
+    size_t count = 0;
+};
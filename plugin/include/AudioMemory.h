@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+/**
+ * AudioMemory - Keep page faults off the audio thread
+ *
+ * The processor collects every buffer processBlock touches into regions,
+ * prefaults them (and optionally locks them into RAM) in prepareToPlay,
+ * and uses the fault counter to check that a block takes none.
+ */
+namespace AudioMemory
+{
+    struct Region {
+        const void* data = nullptr;
+        size_t bytes = 0;
+    };
+
+    // Called once per region by the owners of audio-thread memory
+    using Visitor = std::function<void(const void* data, size_t bytes)>;
+
+    /**
+     * Read one byte per page so swapped-out or not yet mapped pages are
+     * brought in. Memory that was never written maps the shared zero page
+     * and faults again on its first store, so owners zero their buffers
+     * before handing them over.
+     */
+    void prefault(const Region& region);
+
+    /**
+     * Pin the region's pages in RAM; false if the system refuses (e.g.
+     * RLIMIT_MEMLOCK). Unlocking also releases pages shared with other
+     * locked regions, so regions are unlocked together.
+     */
+    bool lock(const Region& region);
+    void unlock(const Region& region);
+
+    /**
+     * Page faults (minor plus major) taken so far: by the calling thread on
+     * Linux, by the whole process elsewhere, where a non-zero delta is only
+     * an upper bound for the audio thread
+     */
+    long pageFaults();
+}
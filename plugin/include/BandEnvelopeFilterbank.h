@@ -0,0 +1,79 @@
+#pragma once
+
+#include "defines.h"
+#include "FeatureExtractor.h"
+#include <array>
+#include <atomic>
+
+/**
+ * BandEnvelopeFilterbank - Band-pass biquads with envelope followers
+ *
+ * Runs on the audio thread at the analysis rate. The state is kept as
+ * structure-of-arrays with the band index innermost, so the per-sample
+ * update of all NumBands filters is a handful of fixed-length loops the
+ * compiler turns into SIMD (8 bands fill one AVX register, 16 fill two, or
+ * four NEON registers). The envelope select is branchless for the same reason.
+ *
+ * Per sample this is ~12 flops per band at 16 kHz, well below the 64-tap FIR
+ * the resampler runs at the host rate. Envelopes are published every
+ * publishInterval samples (0.5 ms at 16 kHz) to relaxed atomics that the
+ * inference thread can read at any time.
+ *
+ * Centre frequencies are log-spaced from 40 Hz to 0.42 * sample rate; each
+ * band is an RBJ constant-0 dB band-pass one band-spacing wide.
+ */
+template <int NumBands>
+class BandEnvelopeFilterbank
+{
+public:
+    static_assert(NumBands % 4 == 0, "Band count should fill whole SIMD registers");
+
+    /**
+     * Design the bank for the analysis rate (audio thread must be stopped)
+     */
+    void prepare(double sampleRate);
+    void reset();
+
+    /**
+     * Audio thread: filter one sample through every band
+     */
+    void process(float x);
+
+    /**
+     * Any thread: copy the latest published envelopes
+     */
+    void getEnvelopes(float* dest) const;
+
+    float getCentreFrequency(int band) const { return centreHz[band]; }
+
+private:
+    // Filter coefficients (transposed direct form II) and state, one lane per band
+    alignas(Constants::cacheLineSize) std::array<float, NumBands> b0{}, b2{}, a1{}, a2{};
+    std::array<float, NumBands> z1{}, z2{};
+    std::array<float, NumBands> env{};
+    std::array<float, NumBands> centreHz{};
+    float attack = 0.0f;
+    float release = 0.0f;
+    int publishInterval = 8;
+    int publishCounter = 0;
+
+    // Read by the inference thread
+    alignas(Constants::cacheLineSize) std::array<std::atomic<float>, NumBands> published{};
+};
+
+/**
+ * BandEnvelopeFeatures - Exposes the filterbank's latest envelopes to the feature chain
+ */
+class BandEnvelopeFeatures : public FeatureExtractor
+{
+public:
+    explicit BandEnvelopeFeatures(const BandEnvelopeFilterbank<Constants::numEnvelopeBands>& bank) : bank(bank) {}
+
+    void prepare(const AnalysisContext&) override {}
+    int getNumFeatures() const override { return Constants::numEnvelopeBands; }
+    int getHistorySize() const override { return 0; }
+    void process(const float*, int, uint64_t, float* features) override { bank.getEnvelopes(features); }
+
+private:
+    const BandEnvelopeFilterbank<Constants::numEnvelopeBands>& bank;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "FeatureExtractor.h"
+#include "AlignedBuffer.h"
+#include <vector>
+
+/**
+ * ConstantQFeatures - Constant-Q magnitudes from one FFT per hop
+ *
+ * Brown & Puckette's efficient constant-Q transform: the complex temporal
+ * kernel of every CQ bin is transformed once at prepare() time, and each
+ * hop the CQ bins are obtained as inner products of a single FFT with those
+ * spectral kernels. The spectral kernels are concentrated around their
+ * centre frequency, so each one is stored as a dense band of FFT bins
+ * (values below 1% of the kernel's peak are dropped) and applied with
+ * vectorized dot products.
+ *
+ * Bins are geometrically spaced from C2 (raised if the FFT is too short
+ * for it) up to 0.45 * sample rate. With chroma enabled, the CQ magnitudes
+ * are followed by a 12-bin pitch-class profile normalized to its maximum.
+ */
+class ConstantQFeatures : public FeatureExtractor
+{
+public:
+    explicit ConstantQFeatures(bool withChroma, int binsPerOctave = 24, int fftSize = Constants::max_nfft);
+
+    void prepare(const AnalysisContext& context) override;
+    int getNumFeatures() const override { return numBins + (withChroma ? 12 : 0); }
+    int getHistorySize() const override { return fftSize; }
+    void process(const float* history, int historySize, uint64_t hopIndex, float* features) override;
+
+    float getMinFrequency() const { return minFrequency; }
+
+private:
+    void buildKernel(const AnalysisContext& context);
+
+    const bool withChroma;
+    const int binsPerOctave;   // Multiple of 12 so bins fold onto pitch classes
+    int fftSize;
+    vDSP_Length log2n = 0;
+    FFTSetup fftSetup = nullptr;
+
+    int numBins = 0;
+    float minFrequency = 0.0f;
+
+    // Banded sparse kernel: bin k uses kernelReal/Imag[offset[k] .. offset[k] + length[k])
+    // against FFT bins start[k] .. start[k] + length[k]. Values are conj(K) / (2N),
+    // which also undoes vDSP's factor of two on the forward real FFT.
+    std::vector<int> kernelStart;
+    std::vector<int> kernelLength;
+    std::vector<int> kernelOffset;
+    AlignedBuffer<float> kernelReal;
+    AlignedBuffer<float> kernelImag;
+    std::vector<int> pitchClass;  // Chroma bin of every CQ bin
+
+    AlignedBuffer<float> fftReal;
+    AlignedBuffer<float> fftImag;
+    AlignedBuffer<float> magnitudes;
+};
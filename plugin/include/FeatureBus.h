@@ -0,0 +1,70 @@
+#pragma once
+
+#include "defines.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * FeatureChannel - One named feature stream on the bus
+ *
+ * Single writer (the publishing instance's analysis thread), any number
+ * of readers. A sequence lock guards the snapshot: the writer makes the
+ * sequence odd while it copies, readers retry if it was odd or moved.
+ * Values are relaxed atomics so an overlapping read is well defined, and
+ * neither side ever blocks.
+ */
+class FeatureChannel
+{
+public:
+    /**
+     * Claim the channel for one publisher; false if another instance holds it
+     */
+    bool claim() { return !claimed.exchange(true, std::memory_order_acq_rel); }
+    void release() { claimed.store(false, std::memory_order_release); }
+
+    void publish(const float* features, int count);
+
+    /**
+     * Copy the latest snapshot (at most maxCount values) into dest;
+     * returns how many were copied, 0 before the first publish
+     */
+    int read(float* dest, int maxCount) const;
+
+    /**
+     * Values in the latest snapshot (0 before the first publish)
+     */
+    int size() const { return count.load(std::memory_order_relaxed); }
+
+private:
+    alignas(Constants::cacheLineSize) std::atomic<uint64_t> sequence{0};
+    std::atomic<int> count{0};
+    std::array<std::atomic<float>, Constants::max_nfft> values{};
+    alignas(Constants::cacheLineSize) std::atomic<bool> claimed{false};
+};
+
+/**
+ * FeatureBus - Process-wide registry of named feature channels
+ *
+ * Instances of the same plugin binary in one host process share it (a
+ * VST3 and an AU instance load separate copies): analysis-only
+ * instances publish their features under a name, a rendering instance
+ * subscribes to several names and runs one forward for all of them.
+ * Lookups take a mutex and happen only on configure(); channels live for
+ * the rest of the process, so a handle never dangles.
+ */
+class FeatureBus
+{
+public:
+    static FeatureBus& instance();
+
+    std::shared_ptr<FeatureChannel> channel(const std::string& name);
+
+private:
+    std::mutex registryMutex;
+    std::map<std::string, std::shared_ptr<FeatureChannel>> channels;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "defines.h"
+#include <Accelerate/Accelerate.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Shared analysis state handed to every feature extractor
+ */
+struct AnalysisContext
+{
+    FFTSetup fftSetup = nullptr;                 // Shared vDSP plan, valid for any size <= max_nfft
+    double sampleRate = Constants::target_sr;    // Analysis sample rate
+    int hopSize = Constants::nfft;               // Samples between consecutive hops
+    int nfft = Constants::nfft;                  // Model input size
+};
+
+/**
+ * FeatureExtractor - Base class for the stages that fill the model input
+ *
+ * Extractors run on the inference thread. Each call receives the analysis
+ * history (oldest sample first, newest last) and the index of the hop it
+ * ends at, and writes getNumFeatures() values. Autolume lays the enabled
+ * extractors out back to back in inference_input_buf.
+ */
+class FeatureExtractor
+{
+public:
+    virtual ~FeatureExtractor() = default;
+
+    /**
+     * Allocate buffers and precompute tables (never called concurrently with process)
+     */
+    virtual void prepare(const AnalysisContext& context) = 0;
+
+    /**
+     * Number of values written by process()
+     */
+    virtual int getNumFeatures() const = 0;
+
+    /**
+     * Number of most recent samples process() reads from the history
+     */
+    virtual int getHistorySize() const = 0;
+
+    /**
+     * @param history Analysis-rate samples, newest last
+     * @param historySize Number of samples in history (>= getHistorySize())
+     * @param hopIndex Index of the hop the history ends at
+     * @param features Output, getNumFeatures() values
+     */
+    virtual void process(const float* history, int historySize, uint64_t hopIndex, float* features) = 0;
+
+    /**
+     * Process every hop queued since the last frame, so hops that arrived
+     * during a slow forward still count. The default analyses only the
+     * newest one.
+     *
+     * @param histories numHops history snapshots, oldest first, stride floats apart
+     * @param lastHopIndex Index of the newest hop
+     */
+    virtual void processBatch(const float* histories, int stride, int numHops, int historySize,
+                              uint64_t lastHopIndex, float* features) {
+        process(histories + static_cast<size_t>(numHops - 1) * stride, historySize, lastHopIndex, features);
+    }
+
+    /**
+     * Slow double-precision version of process() for the accuracy
+     * self-check. Returns false when the extractor has none (the check
+     * then skips it, so stateful extractors are never disturbed).
+     */
+    virtual bool computeReference(const double* history, int historySize, double* features) {
+        (void) history;
+        (void) historySize;
+        (void) features;
+        return false;
+    }
+
+    /**
+     * Run processBatch() and fold its duration into the running cost average
+     */
+    void processTimed(const float* histories, int stride, int numHops, int historySize,
+                      uint64_t lastHopIndex, float* features) {
+        auto start = std::chrono::steady_clock::now();
+        processBatch(histories, stride, numHops, historySize, lastHopIndex, features);
+        float micros = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        float average = averageCostMicros.load(std::memory_order_relaxed);
+        averageCostMicros.store(average == 0.0f ? micros : average + 0.05f * (micros - average),
+                                std::memory_order_relaxed);
+    }
+
+    /**
+     * Exponential moving average of process() time in microseconds
+     */
+    float getAverageCostMicros() const { return averageCostMicros.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<float> averageCostMicros{0.0f};
+};
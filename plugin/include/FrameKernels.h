@@ -0,0 +1,318 @@
+#pragma once
+
+#include "defines.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * FrameKernels - Conversion of model output to displayable RGB888
+ *
+ * The model produces a contiguous [3, H, W] float image in [-1, 1]. The
+ * kernels below scale, clamp and interleave it into packed RGB in a single
+ * pass. Common checkpoint resolutions get a fixed-size instantiation so the
+ * loop bounds are compile-time constants; other sizes use the generic path.
+ *
+ * Sinks that want YUV 4:2:0 get it straight from the same planar frame
+ * (BT.709, limited range). Rows are converted in pairs, one chroma row per
+ * pair, so callers can split a frame between threads on pair boundaries.
+ * The inner loops are branch-free over contiguous planes and vectorise.
+ *
+ * Sinks that want a fixed size get it from a pyramid of 2x box-filtered
+ * levels: each target is resampled bilinearly from the smallest level that
+ * still covers it, so levels are shared and no tap skips more than one
+ * source pixel. Targets are scaled to fill; the aspect ratio is the sink's
+ * business.
+ */
+namespace FrameKernels
+{
+    inline uint8_t toByte(float v) {
+        // [-1, 1] -> [0, 255], truncating like the previous tensor path
+        float scaled = (v + 1.0f) * 127.5f;
+        scaled = scaled < 0.0f ? 0.0f : (scaled > 255.0f ? 255.0f : scaled);
+        return static_cast<uint8_t>(scaled);
+    }
+
+    inline void planarToRgb(const float* chw, uint8_t* rgb, size_t planeSize) {
+        const float* r = chw;
+        const float* g = chw + planeSize;
+        const float* b = chw + 2 * planeSize;
+        for (size_t i = 0; i < planeSize; i++) {
+            rgb[3 * i + 0] = toByte(r[i]);
+            rgb[3 * i + 1] = toByte(g[i]);
+            rgb[3 * i + 2] = toByte(b[i]);
+        }
+    }
+
+    template <int Width, int Height>
+    void planarToRgbFixed(const float* chw, uint8_t* rgb) {
+        constexpr size_t planeSize = static_cast<size_t>(Width) * Height;
+        planarToRgb(chw, rgb, planeSize);
+    }
+
+    using FixedKernel = void (*)(const float*, uint8_t*);
+
+    /**
+     * Return the fixed-size kernel for a square checkpoint size, or nullptr
+     */
+    inline FixedKernel findFixedKernel(int width, int height) {
+        if (width != height) {
+            return nullptr;
+        }
+        switch (width) {
+            case 256:  return &planarToRgbFixed<256, 256>;
+            case 512:  return &planarToRgbFixed<512, 512>;
+            case 1024: return &planarToRgbFixed<1024, 1024>;
+            default:   return nullptr;
+        }
+    }
+
+    inline void planarToRgb(const float* chw, uint8_t* rgb, int width, int height) {
+        if (auto kernel = findFixedKernel(width, height)) {
+            kernel(chw, rgb);
+        } else {
+            planarToRgb(chw, rgb, static_cast<size_t>(width) * height);
+        }
+    }
+
+    // BT.709 on [-1, 1] input: Y = 16 + 219 * luma, C = 128 + 224 * chroma,
+    // with the [0, 1] mapping and a +0.5 rounding folded into the offsets.
+    // Chroma weights apply to the sum of a 2x2 block.
+    namespace Bt709
+    {
+        inline constexpr float kr = 0.2126f;
+        inline constexpr float kb = 0.0722f;
+        inline constexpr float kg = 1.0f - kr - kb;
+
+        inline constexpr float lumaOffset = 16.0f + 109.5f + 0.5f;
+        inline constexpr float lumaR = 109.5f * kr;
+        inline constexpr float lumaG = 109.5f * kg;
+        inline constexpr float lumaB = 109.5f * kb;
+
+        inline constexpr float chromaOffset = 128.0f + 0.5f;
+        inline constexpr float cbR = 28.0f * (-kr / (2.0f * (1.0f - kb)));
+        inline constexpr float cbG = 28.0f * (-kg / (2.0f * (1.0f - kb)));
+        inline constexpr float cbB = 28.0f * 0.5f;
+        inline constexpr float crR = 28.0f * 0.5f;
+        inline constexpr float crG = 28.0f * (-kg / (2.0f * (1.0f - kr)));
+        inline constexpr float crB = 28.0f * (-kb / (2.0f * (1.0f - kr)));
+    }
+
+    inline uint8_t toVideoByte(float v) {
+        return static_cast<uint8_t>(std::min(std::max(v, 0.0f), 255.0f));
+    }
+
+    inline int getChromaWidth(int width) { return (width + 1) / 2; }
+    inline int getChromaHeight(int height) { return (height + 1) / 2; }
+
+    inline size_t getYuv420Bytes(int width, int height) {
+        return static_cast<size_t>(width) * height
+             + 2 * static_cast<size_t>(getChromaWidth(width)) * getChromaHeight(height);
+    }
+
+    /**
+     * Convert row pairs [firstPair, lastPair) of a planar frame; Cb and Cr
+     * samples are ChromaStep bytes apart (2 for NV12's interleaved plane)
+     */
+    template <int ChromaStep>
+    void planarToYuv420Rows(const float* chw, int width, int height, int firstPair, int lastPair,
+                            uint8_t* yPlane, uint8_t* cbPlane, uint8_t* crPlane) {
+        using namespace Bt709;
+        const size_t planeSize = static_cast<size_t>(width) * height;
+        const size_t chromaRow = static_cast<size_t>(getChromaWidth(width)) * ChromaStep;
+        const float* r = chw;
+        const float* g = chw + planeSize;
+        const float* b = chw + 2 * planeSize;
+
+        for (int pair = firstPair; pair < lastPair; pair++) {
+            // An odd last row pairs with itself
+            const int row0 = 2 * pair;
+            const int row1 = std::min(row0 + 1, height - 1);
+
+            for (int row = row0; row <= row1; row++) {
+                const size_t o = static_cast<size_t>(row) * width;
+                uint8_t* y = yPlane + o;
+                for (int x = 0; x < width; x++) {
+                    y[x] = toVideoByte(lumaOffset + lumaR * r[o + x] + lumaG * g[o + x] + lumaB * b[o + x]);
+                }
+            }
+
+            const size_t o0 = static_cast<size_t>(row0) * width;
+            const size_t o1 = static_cast<size_t>(row1) * width;
+            uint8_t* cb = cbPlane + static_cast<size_t>(pair) * chromaRow;
+            uint8_t* cr = crPlane + static_cast<size_t>(pair) * chromaRow;
+            const int fullBlocks = width / 2;
+            for (int c = 0; c < fullBlocks; c++) {
+                const size_t x = 2 * static_cast<size_t>(c);
+                const float rs = r[o0 + x] + r[o0 + x + 1] + r[o1 + x] + r[o1 + x + 1];
+                const float gs = g[o0 + x] + g[o0 + x + 1] + g[o1 + x] + g[o1 + x + 1];
+                const float bs = b[o0 + x] + b[o0 + x + 1] + b[o1 + x] + b[o1 + x + 1];
+                cb[c * ChromaStep] = toVideoByte(chromaOffset + cbR * rs + cbG * gs + cbB * bs);
+                cr[c * ChromaStep] = toVideoByte(chromaOffset + crR * rs + crG * gs + crB * bs);
+            }
+
+            // An odd last column counts twice
+            if (width & 1) {
+                const size_t x = static_cast<size_t>(width) - 1;
+                const float rs = 2.0f * (r[o0 + x] + r[o1 + x]);
+                const float gs = 2.0f * (g[o0 + x] + g[o1 + x]);
+                const float bs = 2.0f * (b[o0 + x] + b[o1 + x]);
+                cb[fullBlocks * ChromaStep] = toVideoByte(chromaOffset + cbR * rs + cbG * gs + cbB * bs);
+                cr[fullBlocks * ChromaStep] = toVideoByte(chromaOffset + crR * rs + crG * gs + crB * bs);
+            }
+        }
+    }
+
+    inline int getYuv420RowPairs(int height) { return getChromaHeight(height); }
+
+    /**
+     * Convert row pairs [firstPair, lastPair) into a whole-frame YUV buffer
+     * of getYuv420Bytes() bytes
+     */
+    inline void planarToYuv420(const float* chw, uint8_t* yuv, int width, int height, YuvLayout layout,
+                               int firstPair, int lastPair) {
+        uint8_t* chroma = yuv + static_cast<size_t>(width) * height;
+        if (layout == YuvLayout::Nv12) {
+            planarToYuv420Rows<2>(chw, width, height, firstPair, lastPair, yuv, chroma, chroma + 1);
+        } else {
+            const size_t chromaPlane = static_cast<size_t>(getChromaWidth(width)) * getChromaHeight(height);
+            planarToYuv420Rows<1>(chw, width, height, firstPair, lastPair, yuv, chroma, chroma + chromaPlane);
+        }
+    }
+
+    /**
+     * Scalar double-precision reference for planarToYuv420, straight from
+     * the BT.709 equations: values are unrounded (clamped to [0, 255]) at
+     * the same offsets as the kernel's bytes. Chroma averages each 2x2
+     * block, repeating the last row or column of an odd frame.
+     */
+    inline void referenceYuv420(const float* chw, double* yuv, int width, int height, YuvLayout layout) {
+        const double kr = 0.2126;
+        const double kb = 0.0722;
+        const double kg = 1.0 - kr - kb;
+        const size_t planeSize = static_cast<size_t>(width) * height;
+        const int chromaWidth = getChromaWidth(width);
+        const size_t chromaPlane = static_cast<size_t>(chromaWidth) * getChromaHeight(height);
+
+        // [-1, 1] -> R'G'B' in [0, 1]
+        auto component = [&](int c, int x, int y) {
+            return (static_cast<double>(chw[c * planeSize + static_cast<size_t>(y) * width + x]) + 1.0) * 0.5;
+        };
+        auto clampByte = [](double v) { return std::min(std::max(v, 0.0), 255.0); };
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                const double luma = kr * component(0, x, y) + kg * component(1, x, y) + kb * component(2, x, y);
+                yuv[static_cast<size_t>(y) * width + x] = clampByte(16.0 + 219.0 * luma);
+            }
+        }
+
+        for (int cy = 0; cy < getChromaHeight(height); cy++) {
+            for (int cx = 0; cx < chromaWidth; cx++) {
+                double r = 0.0, g = 0.0, b = 0.0;
+                for (int dy = 0; dy < 2; dy++) {
+                    for (int dx = 0; dx < 2; dx++) {
+                        const int x = std::min(2 * cx + dx, width - 1);
+                        const int y = std::min(2 * cy + dy, height - 1);
+                        r += 0.25 * component(0, x, y);
+                        g += 0.25 * component(1, x, y);
+                        b += 0.25 * component(2, x, y);
+                    }
+                }
+                const double luma = kr * r + kg * g + kb * b;
+                const double cb = clampByte(128.0 + 224.0 * (b - luma) / (2.0 * (1.0 - kb)));
+                const double cr = clampByte(128.0 + 224.0 * (r - luma) / (2.0 * (1.0 - kr)));
+
+                const size_t index = static_cast<size_t>(cy) * chromaWidth + cx;
+                double* chroma = yuv + planeSize;
+                if (layout == YuvLayout::Nv12) {
+                    chroma[2 * index] = cb;
+                    chroma[2 * index + 1] = cr;
+                } else {
+                    chroma[index] = cb;
+                    chroma[chromaPlane + index] = cr;
+                }
+            }
+        }
+    }
+
+    inline int getHalfSize(int size) { return std::max(1, size / 2); }
+
+    /**
+     * Number of halvings from width x height that still cover the target
+     * (0 for targets at or above the source size)
+     */
+    inline int getPyramidDepth(int width, int height, int targetWidth, int targetHeight) {
+        int depth = 0;
+        while ((width > 1 || height > 1)
+               && getHalfSize(width) >= targetWidth && getHalfSize(height) >= targetHeight) {
+            width = getHalfSize(width);
+            height = getHalfSize(height);
+            depth++;
+        }
+        return depth;
+    }
+
+    /**
+     * Rows [firstRow, lastRow) of the next pyramid level: each pixel is the
+     * mean of a 2x2 block (an odd last row or column is dropped)
+     */
+    inline void downsample2x(const float* chw, int width, int height, float* half, int firstRow, int lastRow) {
+        const int halfWidth = getHalfSize(width);
+        const int halfHeight = getHalfSize(height);
+        const size_t planeSize = static_cast<size_t>(width) * height;
+        const size_t halfPlaneSize = static_cast<size_t>(halfWidth) * halfHeight;
+        const int stepX = width > 1 ? 1 : 0;
+        const int stepY = height > 1 ? 1 : 0;
+
+        for (int c = 0; c < Constants::frameNumCh; c++) {
+            const float* plane = chw + c * planeSize;
+            float* halfPlane = half + c * halfPlaneSize;
+            for (int y = firstRow; y < lastRow; y++) {
+                const float* row0 = plane + static_cast<size_t>(2 * y) * width;
+                const float* row1 = row0 + static_cast<size_t>(stepY) * width;
+                float* out = halfPlane + static_cast<size_t>(y) * halfWidth;
+                for (int x = 0; x < halfWidth; x++) {
+                    const int x0 = 2 * x;
+                    out[x] = 0.25f * (row0[x0] + row0[x0 + stepX] + row1[x0] + row1[x0 + stepX]);
+                }
+            }
+        }
+    }
+
+    /**
+     * Rows [firstRow, lastRow) of a bilinear resample of a planar frame to
+     * packed RGB at targetWidth x targetHeight (pixel centres aligned)
+     */
+    inline void resampleToRgb(const float* chw, int width, int height, uint8_t* rgb,
+                              int targetWidth, int targetHeight, int firstRow, int lastRow) {
+        const size_t planeSize = static_cast<size_t>(width) * height;
+        const float scaleX = static_cast<float>(width) / static_cast<float>(targetWidth);
+        const float scaleY = static_cast<float>(height) / static_cast<float>(targetHeight);
+        const float maxX = static_cast<float>(width - 1);
+        const float maxY = static_cast<float>(height - 1);
+
+        for (int y = firstRow; y < lastRow; y++) {
+            const float sy = std::min(std::max((static_cast<float>(y) + 0.5f) * scaleY - 0.5f, 0.0f), maxY);
+            const int y0 = static_cast<int>(sy);
+            const int y1 = std::min(y0 + 1, height - 1);
+            const float fy = sy - static_cast<float>(y0);
+            uint8_t* out = rgb + static_cast<size_t>(y) * targetWidth * Constants::frameNumCh;
+
+            for (int x = 0; x < targetWidth; x++) {
+                const float sx = std::min(std::max((static_cast<float>(x) + 0.5f) * scaleX - 0.5f, 0.0f), maxX);
+                const int x0 = static_cast<int>(sx);
+                const int x1 = std::min(x0 + 1, width - 1);
+                const float fx = sx - static_cast<float>(x0);
+
+                for (int c = 0; c < Constants::frameNumCh; c++) {
+                    const float* row0 = chw + c * planeSize + static_cast<size_t>(y0) * width;
+                    const float* row1 = chw + c * planeSize + static_cast<size_t>(y1) * width;
+                    const float top = row0[x0] + fx * (row0[x1] - row0[x0]);
+                    const float bottom = row1[x0] + fx * (row1[x1] - row1[x0]);
+                    out[Constants::frameNumCh * x + c] = toByte(top + fy * (bottom - top));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "defines.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bytes the engine holds, by component (see MemoryAccounting)
+struct EngineMemoryUsage
+{
+    size_t weights = 0;             // Parameters and buffers (package size for .pt2)
+    size_t activations = 0;         // Tensors the render slots retain
+    size_t caches = 0;              // Noise bank
+
+    // Device allocator totals, shared by every engine in the process
+    // (0 where the allocator doesn't report them)
+    size_t allocatorAllocated = 0;
+    size_t allocatorReserved = 0;
+};
+
+/**
+ * InferenceEngine - Torch-free boundary between the plugin and the model
+ *
+ * The implementation lives in a separate shared library, the only binary
+ * that links libtorch. Autolume opens it with dlopen when the first model
+ * is loaded, so plugin scans and fresh instances never load libtorch.
+ * Only plain floats and standard types cross the boundary, and no call
+ * throws: failures are logged and reported through return values.
+ */
+class InferenceEngine
+{
+public:
+    virtual ~InferenceEngine() = default;
+
+    /**
+     * Load a TorchScript checkpoint or an AOTInductor package (.pt2)
+     * (GUI thread, before the inference thread starts)
+     */
+    virtual bool loadModel(const std::string& path, const PipelineConfig& config) = 0;
+
+    /**
+     * Row-major [latentDim x numFeatures] basis shipped as <stem>.basis.pt;
+     * false when the model takes the audio features directly
+     */
+    virtual bool getProjectionBasis(std::vector<float>& basis, int& latentDim, int& numFeatures) const = 0;
+
+    /**
+     * Pick the device, apply the configured load-time rewrites and run a
+     * test forward; reports the output frame size (inference thread)
+     */
+    virtual bool initializeDevice(int& width, int& height) = 0;
+
+    /**
+     * Create render slots for concurrent frame workers; returns how many
+     * exist (1 on GPU devices, where workers don't pay off)
+     */
+    virtual int prepareSlots(int requested) = 0;
+
+    /**
+     * Claim a share of the process-wide intra-op thread pool for this
+     * engine's frame workers; the cores are split over every engine that
+     * holds a share, in this instance or another. Only the engine whose
+     * workers run the forwards calls it (layers render on the primary's
+     * workers); 0 gives the share back (inference thread).
+     */
+    virtual void shareThreads(int numWorkers) = 0;
+
+    /**
+     * Render frame seq from the model input (features, or a latent) on one
+     * slot. Returns the planar [3, H, W] output in [-1, 1], owned by the
+     * slot and valid until its next render, or nullptr on failure.
+     */
+    virtual const float* render(int slot, uint64_t seq, const float* input, float seedX, float seedY) = 0;
+
+    // Noise strength control (GUI thread). Not adjustable when the model
+    // has no strengths or they are frozen into a compiled graph; the
+    // setter then logs and ignores the value.
+    virtual void setNoiseStrength(float value) = 0;
+    virtual float getNoiseStrength() const = 0;
+    virtual bool canSetNoiseStrength() const = 0;
+
+    /**
+     * Current footprint; only the MPS allocator reports its totals, other
+     * devices count the tensors the engine retains (inference thread)
+     */
+    virtual void getMemoryUsage(EngineMemoryUsage& usage) const = 0;
+};
+
+// Entry points exported by the engine library (C linkage for dlsym)
+using CreateInferenceEngineFn = InferenceEngine* (*)();
+using DestroyInferenceEngineFn = void (*)(InferenceEngine*);
+
+namespace EngineLibrary
+{
+    inline constexpr const char* createSymbol = "autolumeCreateEngine";
+    inline constexpr const char* destroySymbol = "autolumeDestroyEngine";
+#if defined(__APPLE__)
+    inline constexpr const char* fileName = "libAutolumeEngine.dylib";
+#else
+    inline constexpr const char* fileName = "libAutolumeEngine.so";
+#endif
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "AlignedBuffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * LatentProjection - Audio features to latent vector for latent-input models
+ *
+ * Computes
+ *
+ *     latent = base(seedX, seedY) + B * features
+ *
+ * where B is a [latentDim x numFeatures] projection basis (for example PCA
+ * directions shipped next to the checkpoint) and base() bilinearly blends
+ * standard normal vectors drawn (with this class's own generator) for the
+ * four integer seeds around (seedX, seedY). The walk is independent of
+ * how seed-based models map seeds to latents.
+ * The product is one Accelerate GEMV on the inference thread, so audio
+ * reactivity costs a linear map outside the network.
+ */
+class LatentProjection
+{
+public:
+    /**
+     * Install a row-major basis; numFeatures is the number of leading model
+     * input features it consumes
+     */
+    void setBasis(const float* basis, int latentDim, int numFeatures);
+    void clear();
+
+    /**
+     * Cap the seed cache (0 for the default 8 entries); the least recently
+     * used seeds are evicted to fit. One entry always stays as scratch.
+     */
+    void setCacheBudget(size_t bytes);
+
+    size_t getBasisBytes() const { return basis.sizeInBytes(); }
+    size_t getCacheBytes() const;
+
+    bool isActive() const { return latentDim > 0; }
+    int getLatentDim() const { return latentDim; }
+    int getNumFeatures() const { return numFeatures; }
+
+    /**
+     * @param features At least getNumFeatures() values
+     * @param latent Output, getLatentDim() values
+     */
+    void project(float seedX, float seedY, const float* features, float* latent);
+
+private:
+    // N(0, 1) vector for an integer seed, cached because the walk revisits
+    // the same four corners for many frames
+    const float* seedVector(int64_t seed);
+    // Size the cache for the budget and latent size, keeping recent seeds
+    void resizeCache();
+
+    struct CachedSeed
+    {
+        int64_t seed = 0;
+        bool valid = false;
+        uint64_t lastUse = 0;
+        AlignedBuffer<float> z;
+    };
+
+    int latentDim = 0;
+    int numFeatures = 0;
+    AlignedBuffer<float> basis;
+    static constexpr size_t maxCachedSeeds = 8;
+    std::vector<CachedSeed> seedCache = std::vector<CachedSeed>(maxCachedSeeds);
+    size_t cacheBudget = 0;
+    uint64_t useCounter = 0;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "defines.h"
+#include <cstddef>
+
+/**
+ * LayerCompositor - Blend model layers in their native planar [-1, 1] range
+ *
+ * The blend formulas are the usual ones on [0, 1] colour, rewritten for
+ * the model's range so no layer needs converting first:
+ *
+ *     Add       a + b + 1
+ *     Multiply  (a + 1)(b + 1) / 2 - 1
+ *     Screen    1 - (1 - a)(1 - b) / 2
+ *
+ * The result is cross-faded with the base by opacity. Every step is an
+ * Accelerate vector op over the whole [3, H, W] frame.
+ */
+namespace LayerCompositor
+{
+    /**
+     * Blend layer onto base in place
+     *
+     * @param scratch count floats of working memory
+     */
+    void blend(float* base, const float* layer, float* scratch, size_t count, BlendMode mode, float opacity);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "defines.h"
+#include <vector>
+
+/**
+ * LayerScheduler - Decide which model layers render on each frame
+ *
+ * Layers compete for what is left of the frame period once the primary
+ * model has run. Each frame every layer gains urgency at its priority;
+ * layers at least updateInterval frames old are taken in order of
+ * urgency while their measured forward cost still fits the budget. A
+ * layer that has waited maxIntervalFactor times its interval renders
+ * regardless, so an over-committed budget slows layers down instead of
+ * freezing them. Inference thread only.
+ */
+class LayerScheduler
+{
+public:
+    static constexpr int maxIntervalFactor = 4;
+
+    // Forget every layer's cost and history
+    void reset(int numLayers);
+    // Append a layer, keeping what is known about the others
+    void addLayer();
+    void setSettings(int layer, const LayerSettings& settings);
+
+    /**
+     * Fold a measured forward time into the layer's cost average
+     */
+    void recordCost(int layer, float micros);
+    float getCostMicros(int layer) const { return layers[layer].costMicros; }
+
+    /**
+     * Advance one frame and return the layers to render within budgetMicros
+     */
+    const std::vector<int>& schedule(float budgetMicros);
+
+private:
+    struct Layer
+    {
+        float costMicros = 0.0f;  // Unknown until the first render
+        float priority = 1.0f;
+        int updateInterval = 1;
+        int framesSinceRender = 0;
+        float urgency = 0.0f;
+    };
+
+    std::vector<Layer> layers;
+    std::vector<int> candidates;
+    std::vector<int> scheduled;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "AudioMemory.h"
+#include <algorithm>
+#include <vector>
+
+/**
+ * LookaheadDelay - Fixed delay on the audio pass-through
+ *
+ * Holds the host's audio back by the lookahead while the renderer analyses
+ * the undelayed input, so a frame can be ready before its audio is heard.
+ * The processor reports the delay with setLatencySamples() and the host
+ * compensates the other tracks. Samples are stored in double precision so
+ * both host formats pass through unchanged.
+ */
+class LookaheadDelay
+{
+public:
+    /**
+     * Allocate one line per channel (audio thread must be stopped)
+     */
+    void prepare(int numChannels, int newDelaySamples) {
+        delaySamples = std::max(0, newDelaySamples);
+        lines.assign(static_cast<size_t>(numChannels), std::vector<double>(static_cast<size_t>(delaySamples), 0.0));
+        writePos = 0;
+    }
+
+    int getDelaySamples() const { return delaySamples; }
+
+    /**
+     * Clear the lines to silence (audio thread must be stopped)
+     */
+    void reset() {
+        for (auto& line : lines) {
+            std::fill(line.begin(), line.end(), 0.0);
+        }
+        writePos = 0;
+    }
+
+    void visitMemory(const AudioMemory::Visitor& visit) const {
+        visit(lines.data(), lines.size() * sizeof(lines[0]));
+        for (const auto& line : lines) {
+            visit(line.data(), line.size() * sizeof(double));
+        }
+    }
+
+    /**
+     * Audio thread: delay each channel in place
+     */
+    template <typename SampleType>
+    void process(SampleType* const* channels, int numChannels, int numSamples) {
+        if (delaySamples == 0) {
+            return;
+        }
+
+        const int count = std::min(numChannels, static_cast<int>(lines.size()));
+        for (int ch = 0; ch < count; ch++) {
+            double* line = lines[static_cast<size_t>(ch)].data();
+            SampleType* data = channels[ch];
+            int pos = writePos;
+            for (int s = 0; s < numSamples; s++) {
+                const double delayed = line[pos];
+                line[pos] = static_cast<double>(data[s]);
+                data[s] = static_cast<SampleType>(delayed);
+                pos = pos + 1 == delaySamples ? 0 : pos + 1;
+            }
+        }
+        writePos = static_cast<int>((writePos + static_cast<long long>(numSamples)) % delaySamples);
+    }
+
+private:
+    std::vector<std::vector<double>> lines;
+    int delaySamples = 0;
+    int writePos = 0;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * MemoryAccounting - Bytes held by each component of one Autolume instance
+ *
+ * Owners store their footprint whenever they (re)allocate. The inference
+ * thread refreshes the engine's share, including the device allocator's
+ * statistics, each time it reports telemetry. Any thread may read.
+ */
+class MemoryAccounting
+{
+public:
+    enum class Component
+    {
+        Weights,        // Model parameters and buffers, projection basis
+        Activations,    // Render slot tensors and the allocator's working set
+        AllocatorPool,  // Reserved by the device allocator but not in use
+        FrameBuffers,   // RGB double buffer
+        EditorImages,   // Editor frame copy and image
+        FeatureState,   // Hop ring, histories and model inputs
+        Caches,         // Noise bank and latent seed vectors
+        Count
+    };
+
+    static constexpr size_t numComponents = static_cast<size_t>(Component::Count);
+
+    void set(Component component, size_t numBytes) {
+        bytes[static_cast<size_t>(component)].store(numBytes, std::memory_order_relaxed);
+    }
+
+    size_t get(Component component) const {
+        return bytes[static_cast<size_t>(component)].load(std::memory_order_relaxed);
+    }
+
+    size_t total() const {
+        size_t sum = 0;
+        for (const auto& value : bytes) {
+            sum += value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    static const char* name(Component component) {
+        static constexpr const char* names[numComponents] = {
+            "weights", "activations", "allocator pool", "frame buffers", "editor images", "feature state", "caches"};
+        return names[static_cast<size_t>(component)];
+    }
+
+private:
+    std::array<std::atomic<size_t>, numComponents> bytes{};
+};
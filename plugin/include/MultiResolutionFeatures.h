@@ -0,0 +1,72 @@
+#pragma once
+
+#include "FeatureExtractor.h"
+#include "AlignedBuffer.h"
+#include <vector>
+
+/**
+ * MultiResolutionFeatures - Several STFT sizes over one shared history
+ *
+ * Each resolution covers the band it resolves best: the long FFT the bass,
+ * the short FFT the highs, where its timing matters more than its bin
+ * spacing. All of them read the same analysis history and the shared vDSP
+ * plan. Long FFTs run every few hops and their features are reused in
+ * between; the short FFT runs several times per hop over staggered windows
+ * and keeps the per-bin maximum so transients inside the hop survive.
+ *
+ * Default layout for a 16 kHz analysis rate:
+ * - 4096 points, every 2nd hop, 0 - 500 Hz
+ * - 1024 points, every hop, 500 - 2000 Hz
+ * - 256 points, 2 windows per hop, 2000 Hz - Nyquist
+ */
+class MultiResolutionFeatures : public FeatureExtractor
+{
+public:
+    struct ResolutionSpec
+    {
+        int fftSize;        // Power of two, <= max_nfft
+        int hopInterval;    // Recompute every hopInterval hops
+        int subFrames;      // Windows per computation, spread across one hop
+        double minHz;       // Band covered by this resolution
+        double maxHz;
+        float share;        // Fraction of the feature budget
+    };
+
+    MultiResolutionFeatures();
+    explicit MultiResolutionFeatures(std::vector<ResolutionSpec> specs);
+
+    void prepare(const AnalysisContext& context) override;
+    int getNumFeatures() const override { return numFeatures; }
+    int getHistorySize() const override { return historySize; }
+    void process(const float* history, int historySize, uint64_t hopIndex, float* features) override;
+
+private:
+    struct Resolution
+    {
+        ResolutionSpec spec;
+        vDSP_Length log2n = 0;
+        int firstBin = 0;       // Inclusive
+        int lastBin = 0;        // Exclusive
+        int numFeatures = 0;
+        int featureOffset = 0;
+        float scale = 1.0f;     // 1 / window sum, so magnitudes are comparable across sizes
+        uint64_t lastHop = 0;
+        bool computed = false;
+
+        AlignedBuffer<float> window;
+        AlignedBuffer<float> frame;
+        AlignedBuffer<float> real;
+        AlignedBuffer<float> imag;
+        AlignedBuffer<float> magnitudes;
+        AlignedBuffer<float> peak;
+    };
+
+    void compute(Resolution& res, const float* history, int historySize);
+
+    std::vector<ResolutionSpec> specs;
+    std::vector<Resolution> resolutions;
+    AnalysisContext context;
+    AlignedBuffer<float> cachedFeatures;  // Last features of every resolution
+    int numFeatures = 0;
+    int historySize = 0;
+};
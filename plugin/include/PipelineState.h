@@ -0,0 +1,53 @@
+#pragma once
+
+#include <juce_data_structures/juce_data_structures.h>
+#include "defines.h"
+
+/**
+ * PipelineState - PipelineConfig as a juce::ValueTree
+ *
+ * The processor saves the config in the host's plugin state through this
+ * tree, and the editor edits a copy of it with property components bound
+ * to its properties. Properties are named after the PipelineConfig fields;
+ * enums are stored by index, bus subscriptions as one comma-separated
+ * string and the memory budgets in bytes.
+ */
+namespace PipelineState
+{
+    inline const juce::Identifier type { "PipelineConfig" };
+
+    namespace Keys
+    {
+        inline const juce::Identifier nfft { "nfft" };
+        inline const juce::Identifier targetSampleRate { "targetSampleRate" };
+        inline const juce::Identifier fps { "fps" };
+        inline const juce::Identifier spectralFeatures { "spectralFeatures" };
+        inline const juce::Identifier hopAggregation { "hopAggregation" };
+        inline const juce::Identifier chromaFold { "chromaFold" };
+        inline const juce::Identifier bandEnvelopes { "bandEnvelopes" };
+        inline const juce::Identifier slidingDft { "slidingDft" };
+        inline const juce::Identifier pitchFeatures { "pitchFeatures" };
+        inline const juce::Identifier noiseMode { "noiseMode" };
+        inline const juce::Identifier noiseCycleLength { "noiseCycleLength" };
+        inline const juce::Identifier executionMode { "executionMode" };
+        inline const juce::Identifier channelsLast { "channelsLast" };
+        inline const juce::Identifier verifyAccuracy { "verifyAccuracy" };
+        inline const juce::Identifier inferenceWorkers { "inferenceWorkers" };
+        inline const juce::Identifier taskThreads { "taskThreads" };
+        inline const juce::Identifier lookaheadMs { "lookaheadMs" };
+        inline const juce::Identifier lockAudioMemory { "lockAudioMemory" };
+        inline const juce::Identifier verifyAudioFaults { "verifyAudioFaults" };
+        inline const juce::Identifier analysisOnly { "analysisOnly" };
+        inline const juce::Identifier busPublishName { "busPublishName" };
+        inline const juce::Identifier busSubscriptions { "busSubscriptions" };
+        inline const juce::Identifier noiseBankBudget { "noiseBankBudget" };
+        inline const juce::Identifier latentCacheBudget { "latentCacheBudget" };
+        inline const juce::Identifier renderSlotsBudget { "renderSlotsBudget" };
+    }
+
+    juce::ValueTree toValueTree(const PipelineConfig& config);
+
+    // Properties the tree lacks (older states) keep their defaults, and
+    // out-of-range enum indices fall back to them
+    PipelineConfig fromValueTree(const juce::ValueTree& tree);
+}
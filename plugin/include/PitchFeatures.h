@@ -0,0 +1,57 @@
+#pragma once
+
+#include "FeatureExtractor.h"
+#include "AlignedBuffer.h"
+
+/**
+ * PitchFeatures - YIN pitch and confidence with an FFT difference function
+ *
+ * The latest window is decimated by two (pitch tops out at 1 kHz, so 8 kHz
+ * is plenty) and the YIN difference function is assembled from its
+ * autocorrelation, obtained as the inverse FFT of the power spectrum, plus
+ * prefix sums of the signal energy:
+ *
+ *     d(tau) = sum_{j < L - tau} x_j^2 + sum_{tau <= j < L} x_j^2 - 2 r(tau)
+ *
+ * That replaces the O(L * tauMax) difference loop with one forward and one
+ * inverse real FFT of 512 points through the shared vDSP plan. The usual
+ * cumulative-mean normalization, absolute threshold and parabolic
+ * interpolation follow.
+ *
+ * Outputs two values: pitch as a position on a log-frequency axis from
+ * minFrequency (0) to maxFrequency (1), and confidence (1 - normalized
+ * difference at the chosen lag).
+ */
+class PitchFeatures : public FeatureExtractor
+{
+public:
+    void prepare(const AnalysisContext& context) override;
+    int getNumFeatures() const override { return 2; }
+    int getHistorySize() const override { return windowSize * decimation; }
+    void process(const float* history, int historySize, uint64_t hopIndex, float* features) override;
+
+    static constexpr double minFrequency = 60.0;
+    static constexpr double maxFrequency = 1000.0;
+
+private:
+    static constexpr int decimation = 2;
+    static constexpr float threshold = 0.15f;
+
+    FFTSetup fftSetup = nullptr;
+    double rate = 0.0;          // Decimated sample rate
+    int windowSize = 256;       // Decimated samples analysed per hop
+    int minLag = 0;
+    int maxLag = 0;
+    int fftSize = 0;            // >= windowSize + maxLag, so the correlation doesn't wrap
+    vDSP_Length log2n = 0;
+
+    AlignedBuffer<float> frame;       // Decimated window, zero padded to fftSize
+    AlignedBuffer<float> real;
+    AlignedBuffer<float> imag;
+    AlignedBuffer<float> power;
+    AlignedBuffer<float> correlation;
+    AlignedBuffer<double> energy;     // Prefix sums of frame^2
+    AlignedBuffer<float> cmnd;        // Cumulative mean normalized difference
+
+    float lastPitch = 0.0f;
+};
@@ -1,40 +1,59 @@
-#pragma once
-
-#include "PluginProcessor.h"
-#include "defines.h"
-
-//==============================================================================
-using namespace std;
-class AudioPluginAudioProcessorEditor final : public juce::AudioProcessorEditor, public juce::Timer
-{
-public:
-    explicit AudioPluginAudioProcessorEditor (AudioPluginAudioProcessor&);
-    ~AudioPluginAudioProcessorEditor() override;
-
-    //==============================================================================
-    void paint (juce::Graphics&) override;
-    void resized() override;
-
-    void timerCallback() override;
-private:
-    bool timerStarted = false;
-    // This reference is provided as a quick way for your editor to
-    // access the processor object that created it.
-    AudioPluginAudioProcessor& processorRef;
-    juce::Image image;
-    array<uint8_t, Constants::frameBytes> frameData;
-
-    // Model loading
-    juce::TextButton uploadButton;
-    juce::Label modelPathLabel;
-
-    // Noise strength control
-    juce::Slider noiseSlider;
-    juce::Label noiseLabel;
-
-    // Latent speed control
-    juce::Slider speedSlider;
-    juce::Label speedLabel;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessorEditor)
-};
+#pragma once
+
+#include "PluginProcessor.h"
+#include "defines.h"
+
+//==============================================================================
+using namespace std;
+class AudioPluginAudioProcessorEditor final : public juce::AudioProcessorEditor, public juce::Timer,
+                                              private juce::ValueTree::Listener
+{
+public:
+    explicit AudioPluginAudioProcessorEditor (AudioPluginAudioProcessor&);
+    ~AudioPluginAudioProcessorEditor() override;
+
+    //==============================================================================
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+    void timerCallback() override;
+private:
+    // Pipeline settings column on the right of the controls
+    static constexpr int settingsWidth = 320;
+
+    void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
+
+    // Hand the edited settings to the processor, then show what it applied
+    void applySettings();
+    // Reload the settings from the processor's current config
+    void syncSettings();
+    void addSettingsSections();
+
+    bool timerStarted = false;
+    // This reference is provided as a quick way for your editor to
+    // access the processor object that created it.
+    AudioPluginAudioProcessor& processorRef;
+    juce::Image image;
+    vector<uint8_t> frameData;  // One frame at the video area's size
+
+    // Model loading
+    juce::TextButton uploadButton;
+    juce::Label modelPathLabel;
+
+    // Noise strength control
+    juce::Slider noiseSlider;
+    juce::Label noiseLabel;
+
+    // Latent speed control
+    juce::Slider speedSlider;
+    juce::Label speedLabel;
+
+    // Pipeline config, edited through components bound to settings
+    juce::ValueTree settings;
+    juce::PropertyPanel settingsPanel;
+    bool syncingSettings = false;
+    int seenConfigChanges = 0;
+    int timerFps = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessorEditor)
+};
@@ -1,68 +1,113 @@
-#pragma once
-
-#include <juce_audio_processors/juce_audio_processors.h>
-#include "autolume.h"
-#include "AudioResampler.h"
-#include "defines.h"
-
-//==============================================================================
-class AudioPluginAudioProcessor final : public juce::AudioProcessor
-{
-public:
-    //==============================================================================
-    AudioPluginAudioProcessor();
-    ~AudioPluginAudioProcessor() override;
-
-    //==============================================================================
-    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override;
-
-    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
-
-    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-    using AudioProcessor::processBlock;
-
-    //==============================================================================
-    juce::AudioProcessorEditor* createEditor() override;
-    bool hasEditor() const override;
-
-    //==============================================================================
-    const juce::String getName() const override;
-
-    bool acceptsMidi() const override;
-    bool producesMidi() const override;
-    bool isMidiEffect() const override;
-    double getTailLengthSeconds() const override;
-
-    //==============================================================================
-    int getNumPrograms() override;
-    int getCurrentProgram() override;
-    void setCurrentProgram (int index) override;
-    const juce::String getProgramName (int index) override;
-    void changeProgramName (int index, const juce::String& newName) override;
-
-    //==============================================================================
-    void getStateInformation (juce::MemoryBlock& destData) override;
-    void setStateInformation (const void* data, int sizeInBytes) override;
-
-    // Public access for editor
-    Autolume renderer;
-
-private:
-    // Audio resampler for downsampling (44.1 kHz -> 16 kHz)
-    AudioResampler downsampler;
-
-    // Reconstruction filter for upsampled audio (removes imaging artifacts)
-    AudioResampler reconstructionFilter;
-
-    // Buffer for mono mixed audio (before resampling)
-    std::array<float, Constants::max_buf_size> monoBuffer;
-
-    // Buffer for resampled audio (16 kHz)
-    std::vector<float> resampledBuffer;
-
-    // Buffer for upsampled audio (before reconstruction filter)
-    std::vector<float> upsampledBuffer;
-    //==============================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessor)
-};
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include "autolume.h"
+#include "AudioResampler.h"
+#include "LookaheadDelay.h"
+#include "AudioMemory.h"
+#include "PipelineState.h"
+#include "defines.h"
+
+//==============================================================================
+class AudioPluginAudioProcessor final : public juce::AudioProcessor
+{
+public:
+    //==============================================================================
+    AudioPluginAudioProcessor();
+    ~AudioPluginAudioProcessor() override;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
+
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
+
+    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
+
+    //==============================================================================
+    juce::AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override;
+
+    //==============================================================================
+    const juce::String getName() const override;
+
+    bool acceptsMidi() const override;
+    bool producesMidi() const override;
+    bool isMidiEffect() const override;
+    double getTailLengthSeconds() const override;
+
+    //==============================================================================
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram (int index) override;
+    const juce::String getProgramName (int index) override;
+    void changeProgramName (int index, const juce::String& newName) override;
+
+    //==============================================================================
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+
+    // Public access for editor
+    Autolume renderer;
+
+    // Pipeline config applied in prepareToPlay and saved with the plugin state
+    const PipelineConfig& getPipelineConfig() const { return pipelineConfig; }
+
+    // Apply a new config (message thread). Once prepared, processing is
+    // suspended while the renderer and audio path are reconfigured; a
+    // config the renderer rejects leaves the current one in place.
+    bool setPipelineConfig (const PipelineConfig& newConfig);
+
+    // Bumped on every setPipelineConfig, so the editor can refresh after a
+    // host restores the state
+    int getPipelineConfigChanges() const { return pipelineConfigChanges.load(); }
+
+private:
+    // Resampler, lookahead and buffers for the current config
+    void prepareAudioPath (double sampleRate, int samplesPerBlock);
+
+    PipelineConfig pipelineConfig;
+    std::atomic<int> pipelineConfigChanges { 0 };
+
+    // Between prepareToPlay and releaseResources
+    bool prepared = false;
+
+    // Shared float/double implementation of processBlock
+    template <typename SampleType>
+    void processBlockImpl (juce::AudioBuffer<SampleType>& buffer);
+
+    // Prefault (and with lockAudioMemory, lock) every buffer the audio
+    // thread uses, then run silent blocks so the first host block finds
+    // its code, stack and state resident; logs the faults of one more block
+    void prepareAudioMemory (int samplesPerBlock);
+    void unlockAudioMemory();
+
+    // Audio resampler for downsampling (44.1 kHz -> 16 kHz)
+    AudioResampler downsampler;
+
+    // Reconstruction filter for upsampled audio (removes imaging artifacts)
+    AudioResampler reconstructionFilter;
+
+    // Pass-through delay that gives the renderer its lookahead
+    LookaheadDelay lookahead;
+
+    // Buffer for mono mixed audio (before resampling), in analysis precision
+    std::array<AnalysisSample, Constants::max_buf_size> monoBuffer;
+
+    // Buffer for resampled audio (16 kHz)
+    std::vector<AnalysisSample> resampledBuffer;
+
+    // Buffer for upsampled audio (before reconstruction filter)
+    std::vector<float> upsampledBuffer;
+
+    // Regions locked by prepareAudioMemory, released together
+    std::vector<AudioMemory::Region> lockedRegions;
+
+    // Measure page faults per block (pipelineConfig.verifyAudioFaults,
+    // fixed in prepareToPlay)
+    bool audioFaultCheck = false;
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessor)
+};
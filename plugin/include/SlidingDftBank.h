@@ -0,0 +1,86 @@
+#pragma once
+
+#include "defines.h"
+#include "FeatureExtractor.h"
+#include <array>
+#include <atomic>
+
+/**
+ * SlidingDftBank - Per-sample DFT bins for a few musically important bands
+ *
+ * Each bin is updated on every analysis-rate sample with the damped
+ * sliding DFT recurrence
+ *
+ *     S(n) = r * e^(i 2 pi k / N) * S(n - 1) + x(n) - r^N * x(n - N)
+ *
+ * so its value always covers the last N samples and there is no frame
+ * boundary to wait for. The damping factor r < 1 puts the pole just inside
+ * the unit circle, so rounding errors decay instead of accumulating; the
+ * state runs in double precision. x(n - N) comes from the renderer's input
+ * ring, so the bank keeps no delay line of its own.
+ *
+ * Magnitudes (as sinusoid amplitudes) are published to relaxed atomics on
+ * every sample and can be read lock-free from any thread.
+ */
+class SlidingDftBank
+{
+public:
+    static constexpr int maxBins = 8;
+
+    /**
+     * Design for the analysis rate and window length (audio thread must be stopped).
+     * Frequencies are rounded to the nearest bin of an N-point DFT.
+     */
+    void prepare(double sampleRate, int windowSize);
+    void reset();
+
+    /**
+     * Audio thread: advance every bin by one sample
+     *
+     * @param x Newest sample
+     * @param xDelayed The sample windowSize samples before x
+     */
+    void process(double x, double xDelayed);
+
+    /**
+     * Any thread: copy the latest magnitudes
+     */
+    void getMagnitudes(float* dest) const;
+
+    int getNumBins() const { return numBins; }
+    int getWindowSize() const { return windowSize; }
+
+private:
+    // Kick, kick body, snare body, snare crack, hats (Hz)
+    static constexpr std::array<double, 6> defaultFrequencies{60.0, 100.0, 200.0, 1800.0, 5000.0, 7000.0};
+
+    int numBins = 0;
+    int windowSize = Constants::nfft;
+    double damping = 0.9999;
+    double dampingN = 1.0;    // damping^N
+    double outputScale = 1.0;
+
+    // One lane per bin
+    alignas(Constants::cacheLineSize) std::array<double, maxBins> re{}, im{};
+    std::array<double, maxBins> rotRe{}, rotIm{};  // r * e^(i 2 pi k / N)
+
+    // Read by the inference thread
+    alignas(Constants::cacheLineSize) std::array<std::atomic<float>, maxBins> published{};
+};
+
+/**
+ * SlidingDftFeatures - Exposes the latest sliding DFT magnitudes to the feature chain
+ */
+class SlidingDftFeatures : public FeatureExtractor
+{
+public:
+    explicit SlidingDftFeatures(const SlidingDftBank& bank) : bank(bank) {}
+
+    void prepare(const AnalysisContext&) override {}
+    int getNumFeatures() const override { return bank.getNumBins(); }
+    int getHistorySize() const override { return 0; }
+    void process(const float*, int, uint64_t, float* features) override { bank.getMagnitudes(features); }
+
+private:
+    const SlidingDftBank& bank;
+};
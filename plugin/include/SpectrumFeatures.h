@@ -0,0 +1,47 @@
+#pragma once
+
+#include "FeatureExtractor.h"
+#include "AlignedBuffer.h"
+
+/**
+ * SpectrumFeatures - Magnitude spectrum of the latest hop
+ *
+ * One real FFT of the last nfft samples (no window), producing nfft / 2
+ * magnitudes. This is the original Autolume model input.
+ *
+ * When the inference thread falls behind, the hops queued since the last
+ * frame are transformed together with one multi-signal vDSP call and
+ * reduced per bin (max, mean or positive flux) so transients that arrived
+ * during a slow forward still reach the model.
+ */
+class SpectrumFeatures : public FeatureExtractor
+{
+public:
+    explicit SpectrumFeatures(HopAggregation aggregation = HopAggregation::Latest) : aggregation(aggregation) {}
+
+    void prepare(const AnalysisContext& context) override;
+    int getNumFeatures() const override { return fftSize / 2; }
+    int getHistorySize() const override { return fftSize; }
+    void process(const float* history, int historySize, uint64_t hopIndex, float* features) override;
+    void processBatch(const float* histories, int stride, int numHops, int historySize,
+                      uint64_t lastHopIndex, float* features) override;
+    bool computeReference(const double* history, int historySize, double* features) override;
+
+private:
+    const HopAggregation aggregation;
+    FFTSetup fftSetup = nullptr;
+    vDSP_Length fftLog2n = 0;
+    int fftSize = Constants::nfft;
+
+    AlignedBuffer<float> fftReal;
+    AlignedBuffer<float> fftImag;
+
+    // Batched path: numHopSlots signals, fftSize / 2 complex values apart
+    AlignedBuffer<float> batchReal;
+    AlignedBuffer<float> batchImag;
+    AlignedBuffer<float> batchMagnitudes;
+    AlignedBuffer<float> previousSpectrum;  // Newest spectrum of the previous batch (flux)
+    AlignedBuffer<float> lastOutput;
+    uint64_t lastBatchHop = 0;
+    bool hasPrevious = false;
+};
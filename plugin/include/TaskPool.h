@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * TaskPool - The renderer's threads for everything that isn't a forward
+ *
+ * Frame conversion, compositing and any later post-effects or encoding
+ * share one bounded set of threads instead of starting their own next to
+ * libtorch's pool and the frame workers. Each thread keeps a deque per
+ * priority: it runs its own newest task first and, when idle, steals the
+ * oldest task of the highest priority from another thread. Callers of
+ * parallelFor() run part of the range themselves and then help with
+ * queued tasks; once none are left to take they sleep until their last
+ * band, already running elsewhere, is done. Calls may be nested. Tasks
+ * must not throw.
+ */
+class TaskPool
+{
+public:
+    enum class Priority {
+        High,       // On the path of the frame being published
+        Normal,
+        Low         // Background work that may lag a frame
+    };
+
+    ~TaskPool() { stop(); }
+
+    /**
+     * Start numThreads threads (0 for half the cores); without threads
+     * every call runs inline on the caller
+     */
+    void start(int numThreads);
+    // Finish the queued tasks and join the threads
+    void stop();
+    int getNumThreads() const { return static_cast<int>(workers.size()); }
+
+    void submit(std::function<void()> task, Priority priority = Priority::Normal);
+
+    /**
+     * Run fn(begin, end) over [0, count) in bands of at least grain items
+     * and return once every band is done
+     */
+    void parallelFor(int count, int grain, const std::function<void(int, int)>& fn,
+                     Priority priority = Priority::High);
+
+private:
+    static constexpr int numPriorities = 3;
+
+    struct Worker {
+        std::mutex queueMutex;
+        std::array<std::deque<std::function<void()>>, numPriorities> queues;
+        std::thread thread;
+    };
+
+    void workerLoop(int index);
+    // Pop a task from worker self (newest first) or steal one from another
+    // (oldest first); self is -1 for threads outside the pool
+    bool takeTask(int self, std::function<void()>& task);
+    bool runOne(int self);
+    int currentWorker() const;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t> nextQueue{0};  // Round-robin target for outside submissions
+    std::atomic<int> pending{0};       // Queued, not yet taken
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+};
@@ -1,11 +1,27 @@
-#include <torch/torch.h>
-#include <torch/script.h>
 #include "defines.h"
+#include "InferenceEngine.h"
+#include "AlignedBuffer.h"
+#include "FeatureExtractor.h"
+#include "BandEnvelopeFilterbank.h"
+#include "SlidingDftBank.h"
+#include "LatentProjection.h"
+#include "FeatureBus.h"
+#include "MemoryAccounting.h"
+#include "LayerScheduler.h"
+#include "FrameKernels.h"
+#include "TaskPool.h"
+#include "AudioMemory.h"
+#include <memory>
+#include <string>
 #include <vector>
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <Accelerate/Accelerate.h>
 
 using namespace std;
@@ -18,83 +34,476 @@ public:
     // Must be called after JUCE initialization (e.g., in prepareToPlay)
     void initialize();
 
-    // Load model from file path (called from GUI thread)
+    // Apply analysis geometry (audio must be stopped, e.g. from prepareToPlay).
+    // The analysis size can't change once a model is loaded.
+    bool configure(const PipelineConfig& newConfig);
+    // Snapshot of the current config (takes featureMutex)
+    PipelineConfig getConfig();
+
+    // Load model from file path (called from GUI thread): a TorchScript
+    // checkpoint, or an AOTInductor package (.pt2)
     bool loadModel(const std::string& path);
 
+    // Composite another model over the primary one (GUI thread). The layer
+    // loads here; the inference thread sets up its device (including the
+    // load-time rewrite checks) between two frames and then adds it to the
+    // frame. It must render at the primary model's frame size, and a device
+    // failure is only logged.
+    bool addLayer(const std::string& path, const LayerSettings& settings);
+    // Change a layer's blend, routing, walk or schedule (GUI thread); layers
+    // are numbered in the order they were added
+    bool setLayerSettings(int index, const LayerSettings& settings);
+    // Remove every layer (GUI thread)
+    void clearLayers();
+    int getNumLayers();
+
     // Check if renderer is ready for use
     bool isReady() const {
         return isInitialized.load(std::memory_order_acquire) &&
                modelLoaded.load(std::memory_order_acquire);
     }
 
-    void processAudio(float val);
+    // Audio thread: ingest one analysis-rate sample (float or double)
+    template <typename SampleType>
+    void processAudio(SampleType val);
+
+    // Hand every buffer processAudio touches to visit, so the processor can
+    // prefault and lock them before playback
+    void visitAudioMemory(const AudioMemory::Visitor& visit) const;
+    // Audio thread: page faults taken by a block (with verifyAudioFaults)
+    void addAudioPageFaults(long count) {
+        audioPageFaults.store(audioPageFaults.load(std::memory_order_relaxed) + static_cast<uint64_t>(count),
+                              std::memory_order_relaxed);
+    }
+    uint64_t getAudioPageFaults() const { return audioPageFaults.load(std::memory_order_relaxed); }
+
+    // Bracket the blocks the processor runs before playback (audio thread
+    // stopped). In between, hops are never published; ending clears the
+    // sample ring, the per-sample banks and the hop counter they advanced.
+    void beginAudioWarmUp();
+    void endAudioWarmUp();
 
     // Called from GUI thread: request inference to run
     void requestInference();
 
-    // Called from GUI thread: copy latest 512x512 RGB frame into dest
+    // Called from GUI thread: copy latest RGB frame into dest
     bool getLatestFrame (uint8_t* dest, size_t numBytes);
 
+    // YUV 4:2:0 for recording and streaming sinks (any thread). While a
+    // layout has subscribers it is converted once per published frame,
+    // from the same composited frame as the RGB copy, and shared by all.
+    void subscribeYuv(YuvLayout layout);
+    void unsubscribeYuv(YuvLayout layout);
+    size_t getYuvFrameBytes() const { return FrameKernels::getYuv420Bytes(getFrameWidth(), getFrameHeight()); }
+    // Copy the shown frame in layout; false until a frame converted after
+    // the subscription is shown
+    bool getLatestYuvFrame(YuvLayout layout, uint8_t* dest, size_t numBytes);
+
+    // Fixed-size RGB for sinks that don't show the native frame (any
+    // thread). Every subscribed size is built once per published frame
+    // from a shared pyramid of 2x levels; the native size is served from
+    // the RGB copy. False for an empty size.
+    bool subscribeSize(int width, int height);
+    void unsubscribeSize(int width, int height);
+    // Copy the shown frame at width x height; false until a frame built
+    // after the subscription is shown
+    bool getLatestFrame(int width, int height, uint8_t* dest, size_t numBytes);
+
+    // Frame geometry, discovered from the model's test forward pass
+    int getFrameWidth() const { return infer.frameWidth.load(std::memory_order_acquire); }
+    int getFrameHeight() const { return infer.frameHeight.load(std::memory_order_acquire); }
+    size_t getFrameBytes() const {
+        return static_cast<size_t>(getFrameWidth()) * getFrameHeight() * Constants::frameNumCh;
+    }
+
     // Noise strength control (called from GUI thread)
     void setNoiseStrength(float value);
     float getNoiseStrength() const;
+    // False without a model, or when its strengths are fixed (any thread)
+    bool canSetNoiseStrength() const;
 
     // Latent control (called from GUI thread)
     void setLatentSpeed(float value);
     float getLatentSpeed() const;
 
+    // Average per-hop cost of the feature stage in microseconds (any thread)
+    float getAnalysisCostMicros() const { return infer.analysisCostMicros.load(std::memory_order_relaxed); }
+
+    // Hops that were overwritten before the inference thread could drain them
+    uint64_t getDroppedHops() const { return infer.droppedHops.load(std::memory_order_relaxed); }
+
+    // Bytes held per component (any thread). The editor reports its frame
+    // copies through the non-const overload.
+    const MemoryAccounting& getMemoryAccounting() const { return memory; }
+    MemoryAccounting& getMemoryAccounting() { return memory; }
+
 private:
-    // Find and cache noise_strength parameters from model
-    void findNoiseStrengthParameters();
+    // Open the engine library and create the engine (first model load only)
+    bool loadEngine();
+    // Analysis-only mode: extract and publish features at the frame rate
+    void analysisThreadLoop();
+    // Stop the inference or analysis thread and reset its frame bookkeeping
+    void stopInferenceThread();
+    // Resolve bus channels for the config (featureMutex held)
+    void connectFeatureBus(const PipelineConfig& newConfig, int numLocalFeatures);
+    // Log once when a stream publishes more values than its slice holds
+    struct BusSubscription;
+    void reportBusTruncation(BusSubscription& subscription);
     // Inference thread
     void inferenceThreadLoop();
     void runInference();
+    // Render on a primary engine slot and fold the time into the cost average
+    const float* renderPrimary(int slot, uint64_t seq, const float* input, float seedX, float seedY);
+    // Drop layers on request or when they no longer match the frame size,
+    // and set up and adopt newly loaded ones (inference thread)
+    void updateLayers();
+    // Device, render slots and frame buffer for a loaded layer (inference
+    // thread, after the workers have started)
+    struct ModelLayer;
+    void setUpLayer(ModelLayer& layer);
+    struct FrameJob;
+    // Add the layers the scheduler picks for this frame to job, with their
+    // inputs routed from inference_input_buf (inference thread)
+    void scheduleLayers(FrameJob& job);
+    // Render job's layers and primary frame on a worker's slots, then
+    // publish it (a worker, or the inference thread without workers)
+    void renderFrame(FrameJob& job, int slot);
+    // Make job's layer frames the layers' current ones (publishFrame only)
+    void adoptLayerFrames(FrameJob& job);
+    // Blend the layers over the primary output; returns the frame to publish
+    // (publishFrame only)
+    const float* compositeLayers(const float* output);
+    // Extract features and advance the latent walk for the next frame;
+    // returns the model input (features, or the projected latent)
+    float* prepareModelInput(float& seedX, float& seedY);
+    // Publish frame seq once every earlier frame is out, to be shown at due
+    // (null output only advances the sequence). The layer frames rendered
+    // for job become current first, so layers follow the frame order.
+    void publishFrame(uint64_t seq, const float* output, std::chrono::steady_clock::time_point due,
+                      FrameJob* job = nullptr);
+    // Move queued frames that are due to the shown slot (holds frameMutex)
+    void advanceShownFrame();
+
+    // Copy every history snapshot published since the last read into dest
+    // (oldest first, max_nfft apart, narrowed to float for the feature
+    // stage); returns how many, and the newest hop's index in hopIndex
+    int readQueuedHops(float* dest, uint64_t& hopIndex);
+    // Extractors for newConfig, unprepared; the envelope and sliding DFT
+    // stages read the given banks
+    vector<unique_ptr<FeatureExtractor>> makeFeatureChain(const PipelineConfig& newConfig,
+                                                          const BandEnvelopeFilterbank<Constants::numEnvelopeBands>& envelopes,
+                                                          const SlidingDftBank& sliding) const;
+    AnalysisContext makeAnalysisContext(const PipelineConfig& newConfig) const;
+    // Build the feature extractors for newConfig and swap them in with the
+    // config and its bus channels (takes featureMutex)
+    bool rebuildFeatureChain(const PipelineConfig& newConfig);
+    // Fill inference_input_buf from the latest history
+    void extractFeatures();
+    // Compare each extractor of newConfig's chain (a private copy) with its
+    // double-precision reference on fixed test signals and log PSNR / max
+    // error; false if any fails
+    bool verifyFeatureAccuracy(const PipelineConfig& newConfig);
+    // Compare the YUV 4:2:0 kernels (both layouts, odd and even sizes,
+    // converted in row-pair bands) with the scalar BT.709 reference
+    bool verifyFrameKernels();
+    // Reallocate the frame queue for the size and the configured lookahead
+    // (inference thread, with no frame in flight)
+    void allocateFrameBuffers(int width, int height);
+    int getNumFrameBuffers() const;
+    // Record the analysis and model input buffers (whenever they change size)
+    void accountFeatureState();
+    // Refresh the engine's and the projection's share and log the totals
+    // (inference thread)
+    void reportMemory();
+
+    // Written by configure() under featureMutex; the GUI, inference,
+    // worker and analysis threads read it only under that lock (getConfig()
+    // snapshots it), and otherwise use the live copies below
+    PipelineConfig config;
+    MemoryAccounting memory;
 
-    // Model
-    torch::jit::script::Module model;
-    torch::Device device{torch::kCPU};  // Start with CPU, switch to MPS on inference thread
-    torch::Tensor inputTensor;
-    vector<torch::jit::IValue> inputs;
+    // Model: libtorch lives behind the engine, loaded on first use
+    InferenceEngine* engine = nullptr;
+    CreateInferenceEngineFn createEngine = nullptr;  // Also creates the layers' engines
+    DestroyInferenceEngineFn destroyEngine = nullptr;
     std::string modelPath;  // Path to loaded model
 
-    // Noise strength parameters (cached for real-time control)
-    std::vector<torch::Tensor> noiseStrengthParams;
+    // Latent-input models take forward(latent [1, D]) instead of the audio
+    // buffer plus seeds; the projection maps features to that latent
+    LatentProjection latentProjection;
+    AlignedBuffer<float> latentBuf;
+
+    // Frame-level parallelism: with inferenceWorkers > 1 the inference
+    // thread only prepares inputs and hands frame seq to worker
+    // seq % K. Workers render on their own engine slot and publish in
+    // sequence order, so at most K frames are in flight.
+    struct ModelLayer;
+
+    // One layer forward scheduled into a frame: inputs are prepared on the
+    // inference thread in frame order, the frame's worker renders it, and
+    // it becomes the layer's current frame when that frame is published
+    struct LayerJob {
+        shared_ptr<ModelLayer> layer;  // Released once the frame is out
+        uint64_t seq = 0;
+        float seedX = 0.0f;
+        float seedY = 0.0f;
+        AlignedBuffer<float> input;    // Routed features or projected latent
+        AlignedBuffer<float> output;   // Swapped with the layer's frame on publish
+        bool rendered = false;
+    };
+
+    struct FrameJob {
+        uint64_t seq = 0;
+        float seedX = 0.0f;
+        float seedY = 0.0f;
+        std::chrono::steady_clock::time_point due;  // When the frame's audio is heard
+        AlignedBuffer<float> input;  // Copy of the prepared model input
+        vector<LayerJob> layerJobs;  // Reused; the first numLayerJobs are this frame's
+        int numLayerJobs = 0;
+    };
+
+    struct InferenceWorker {
+        thread worker;
+        mutex jobMutex;
+        condition_variable jobChanged;  // Job handed over or finished
+        bool hasJob = false;
+        FrameJob job;
+        int slot = 0;                   // Engine render slot
+    };
+
+    void startWorkers(int numWorkers);
+    void stopWorkers();
+    void workerLoop(InferenceWorker& worker);
+
+    vector<unique_ptr<InferenceWorker>> workers;
+    FrameJob inlineJob;            // Rendered by the inference thread without workers
+    uint64_t nextDispatchSeq = 0;  // Inference thread only
+    uint64_t nextPublishSeq = 0;   // Guarded by publishMutex
+    mutex publishMutex;
+    condition_variable publishTurn;
+
+    // Model layers composited over the primary frame, each with its own
+    // engine, latent walk and slice of the model input features. Only the
+    // inference thread changes the list, under layerMutex; GUI edits of
+    // settings, the compositor's reads and frame adoption also hold it.
+    // Layer forwards run on the frame workers, one engine slot per worker
+    // where the device allows, otherwise sharing slots under their locks.
+    struct ModelLayer {
+        ~ModelLayer() {
+            if (engine) {
+                destroy(engine);
+            }
+        }
+
+        InferenceEngine* engine = nullptr;
+        DestroyInferenceEngineFn destroy = nullptr;
+        std::string path;
+        bool ready = false;             // Device set up (inference thread)
+        bool failed = false;            // Device setup failed, dropped when adopted
+        int width = 0;
+        int height = 0;
+        size_t frameSize = 0;           // Planar floats per frame
+        int numSlots = 1;
+        unique_ptr<mutex[]> slotMutexes;
+        LayerSettings settings;         // Written by the GUI thread
+        LayerSettings active;           // Inference thread copy for this frame
+        LatentProjection projection;
+        AlignedBuffer<float> input;     // Routed features, zero-padded to nfft
+        size_t inputSize = 0;           // Model input floats: nfft, or the latent size
+        AlignedBuffer<float> frame;     // Current planar frame, read by the compositor
+        bool hasFrame = false;
+        float seedX = 0.0f;
+        uint64_t seq = 0;
+        std::chrono::steady_clock::time_point lastUpdate;
+        atomic<float> lastCostMicros{0.0f};  // Newest forward time, from a worker
+        atomic<uint32_t> costSamples{0};     // Bumped with each new time
+        uint32_t seenCostSamples = 0;        // Inference thread
+    };
+
+    vector<shared_ptr<ModelLayer>> layers;
+    vector<shared_ptr<ModelLayer>> pendingLayers;  // Loaded, waiting for the inference thread to set them up
+    atomic<size_t> layerJobBytes{0};               // Layer job buffers, for accounting
+    atomic<bool> clearLayersRequested{false};
+    LayerScheduler layerScheduler;                 // Inference thread
+    AlignedBuffer<float> compositeBuf;             // Primary frame with the layers blended in
+    AlignedBuffer<float> compositeScratch;
+    mutex layerMutex;
+
+    // Non-torch parallel work (frame conversion, compositing). Runs while
+    // the inference thread does; calls run inline when it is stopped.
+    TaskPool taskPool;
 
     // Latent control state
-    atomic<float> latentX{0.0f};
-    atomic<float> latentY{0.0f};
-    atomic<float> latentSpeed{0.25f};
     std::chrono::steady_clock::time_point lastLatentUpdate;
 
+    // ------------------------------------------------------------------
+    // Cross-thread state, partitioned by writer. Every block starts on its
+    // own cache line so a store from one thread never invalidates a line
+    // another thread is writing to; readers only pull in the owner's line.
+    // ------------------------------------------------------------------
+
+    // Written by the GUI thread, read by the inference thread
+    struct alignas(Constants::cacheLineSize) GuiState {
+        atomic<float> latentSpeed{0.25f};
+        atomic<uint32_t> inferenceRequestSeq{0};  // Bumped once per request
+    };
+
+    // Written by the inference thread, read by the GUI thread
+    struct alignas(Constants::cacheLineSize) InferenceState {
+        atomic<float> latentX{0.0f};
+        atomic<float> latentY{0.0f};
+        atomic<int> maxFramesInFlight{1};         // One per worker
+        atomic<uint32_t> inferenceServedSeq{0};   // Last request the loop picked up
+        atomic<int> frameWidth{Constants::frameWidth};
+        atomic<int> frameHeight{Constants::frameHeight};
+        atomic<float> analysisCostMicros{0.0f};
+        atomic<uint64_t> droppedHops{0};          // Hops overwritten before the feature stage saw them
+    };
+
+    // Written by whichever thread renders and publishes a frame: a frame
+    // worker, or the inference thread without workers. The dispatcher's
+    // increment of framesInFlight is the one store from outside.
+    struct alignas(Constants::cacheLineSize) WorkerState {
+        atomic<int> framesInFlight{0};            // Dispatched but not yet published
+        atomic<float> primaryCostMicros{0.0f};    // Average primary model forward
+    };
+
+    // Private to the audio thread
+    struct alignas(Constants::cacheLineSize) AudioState {
+        int rp = 0;
+        int cnt = 0;
+        int hopSize = Constants::nfft;      // Copied from config in configure()
+        int historySize = Constants::nfft;  // Samples published per hop (longest extractor window)
+        bool bandEnvelopes = false;         // Run the envelope filterbank per sample
+        bool slidingDft = false;            // Run the sliding DFT bins per sample
+        bool warmUp = false;                // Hops go to the scratch slot, unpublished
+    };
+
+    // Written by configure(), read by the inference, worker and analysis
+    // threads in place of config (which holds strings and vectors)
+    struct alignas(Constants::cacheLineSize) LiveConfig {
+        atomic<int> nfft{Constants::nfft};
+        atomic<int> fps{Constants::fps};
+        atomic<double> lookaheadMs{0.0};
+        atomic<int> inferenceWorkers{1};
+        atomic<int> taskThreads{0};
+        atomic<bool> verifyAudioFaults{false};
+    };
+
+    GuiState gui;
+    InferenceState infer;
+    WorkerState work;
+    AudioState audio;
+    LiveConfig live;
+
     // Audio thread data
-    array<float, Constants::max_buf_size> in_buf;
-    int rp = 0;
-    int cnt = 0;
+    alignas(Constants::cacheLineSize) array<AnalysisSample, Constants::max_buf_size> in_buf;
+    BandEnvelopeFilterbank<Constants::numEnvelopeBands> bandEnvelopes;
+    SlidingDftBank slidingDft;
+
+    // Hop snapshots: single producer (audio thread), single consumer
+    // (inference thread). Indices count hops monotonically; the slot for
+    // hop i is i % numHopSlots. Producer and consumer indices live on
+    // separate cache lines. Slots are max_nfft apart so any configured
+    // analysis size fits without reallocating. One extra slot past the ring
+    // takes the hops of warm-up blocks.
+    AlignedBuffer<AnalysisSample> hopSlots;
+    alignas(Constants::cacheLineSize) atomic<uint64_t> hopWriteIndex{0};  // Audio thread
+    atomic<uint64_t> audioPageFaults{0};                                 // Audio thread, with verifyAudioFaults
+    array<atomic<int64_t>, Constants::numHopSlots> hopTimes{};           // steady_clock ticks when each slot was published
+    alignas(Constants::cacheLineSize) atomic<uint64_t> hopReadIndex{0};   // Inference thread
+
+    // Inference thread data
+    AlignedBuffer<float> queuedHistories;      // Hops drained from the ring for one frame
+    AlignedBuffer<float> analysisHistory;      // Latest history snapshot, newest sample last
+    AlignedBuffer<float> inference_input_buf;  // Feature vector for inference
+    uint64_t lastHopIndex = 0;
+    std::chrono::steady_clock::time_point analysedHopTime;  // Arrival of the newest hop analysed
+    int analysisHistorySize = Constants::nfft;  // Inference-side copy of audio.historySize
 
-    // Shared between audio thread (write) and inference thread (read)
-    alignas(64) atomic<bool> inputReady{false};
-    array<float, Constants::nfft> ordered_in_buf;  // Written by audio thread
-    array<float, Constants::nfft> inference_input_buf;  // FFT magnitude output for inference
+    // Feature stage: extractors laid out back to back in inference_input_buf
+    vector<unique_ptr<FeatureExtractor>> featureChain;
 
-    // FFT setup (vDSP Accelerate framework)
+    // Feature bus: local features are published as they are extracted.
+    // Each subscribed stream owns a fixed slice of what they leave of nfft,
+    // holding the values it last delivered, so a stream that misses a
+    // frame never moves the others.
+    struct BusSubscription {
+        std::string name;
+        shared_ptr<FeatureChannel> channel;
+        vector<float> values;  // busSliceSize, zero until the first read
+        bool truncationReported = false;
+    };
+    shared_ptr<FeatureChannel> busPublication;
+    vector<BusSubscription> busSubscriptions;
+    int busSliceSize = 0;
+    AlignedBuffer<float> busScratch;  // A read lands here and is kept only if it succeeds
+    mutex featureMutex;  // Guards featureChain and config against reconfiguration
+
+    // FFT setup (vDSP Accelerate framework). The setup is created once for
+    // max_nfft and shared by every extractor, whatever its size.
     FFTSetup fftSetup;
-    DSPSplitComplex fftSplit;
-    array<float, Constants::nfft / 2> fftReal;
-    array<float, Constants::nfft / 2> fftImag;
-    vDSP_Length fftLog2n;
-
-    // Double buffer for frames: written by inference thread, read by GUI thread
-    array<uint8_t, Constants::frameBytes> frameBuffer[2];
-    atomic<int> readableFrameIndex{0};  // Which buffer is ready for GUI to read
-    int writeFrameIndex = 1;  // Which buffer inference thread writes to
-    mutex frameMutex;  // Protects frame swap
-
-    // Thread control
-    atomic<bool> shouldExit{false};
+
+    // Frame queue: published frames wait with the time their audio is heard
+    // (the newest analysed hop plus the lookahead) and the GUI shows the
+    // newest one that is due. Without lookahead every frame is due at once,
+    // which behaves like a double buffer. There is a buffer for each frame
+    // of lookahead plus the shown, the written and one spare.
+    struct QueuedFrame {
+        int buffer = 0;
+        std::chrono::steady_clock::time_point due;
+    };
+
+    static constexpr int numYuvLayouts = 2;
+
+    struct FrameSize {
+        int width = 0;
+        int height = 0;
+        bool operator==(const FrameSize& other) const { return width == other.width && height == other.height; }
+    };
+
+    struct SizedFrame {
+        FrameSize size;
+        AlignedBuffer<uint8_t> rgb;
+    };
+
+    // One queued frame: RGB for the editor plus each YUV layout and size a
+    // sink subscribed to when it was published (allocated on first use)
+    struct FrameSlot {
+        AlignedBuffer<uint8_t> rgb;
+        array<AlignedBuffer<uint8_t>, numYuvLayouts> yuv;
+        array<bool, numYuvLayouts> hasYuv{};
+        vector<SizedFrame> sized;
+    };
+
+    // Build the subscribed sizes of one frame into slot (publishFrame only)
+    void buildSizedFrames(const float* frame, int width, int height, FrameSlot& slot);
+
+    vector<FrameSlot> frameBuffers;
+    vector<int> freeFrameBuffers;      // Guarded by frameMutex
+    vector<QueuedFrame> queuedFrames;  // Oldest first, guarded by frameMutex
+    int shownFrameBuffer = 0;          // Guarded by frameMutex
+    int writeFrameIndex = 1;           // publishFrame only
+    mutex frameMutex;
+    alignas(Constants::cacheLineSize) array<atomic<int>, numYuvLayouts> yuvSubscribers{};
+    atomic<size_t> yuvFrameBytes{0};  // YUV buffers allocated so far, for accounting
+
+    // Subscribed sink sizes (counted per subscriber) and the publisher's
+    // pyramid: level k is the frame halved k times, level 0 the frame itself
+    struct SizeSubscription {
+        FrameSize size;
+        int subscribers = 0;
+    };
+    vector<SizeSubscription> sizeSubscriptions;  // Guarded by sizeMutex
+    mutex sizeMutex;
+    vector<FrameSize> pyramidTargets;            // publishFrame only
+    vector<AlignedBuffer<float>> pyramidLevels;  // publishFrame only; [k - 1] holds level k
+    atomic<size_t> sizedFrameBytes{0};           // Pyramid levels and sized copies, for accounting
+
+    // Thread control (written once per lifecycle change, read-mostly)
+    alignas(Constants::cacheLineSize) atomic<bool> shouldExit{false};
     atomic<bool> isInitialized{false};
     atomic<bool> modelLoaded{false};
     atomic<bool> mpsInitialized{false};
-    atomic<bool> inferenceRunning{false};  // Prevent overlapping inference calls
-    atomic<bool> inferenceRequested{false};  // Signal from GUI thread to inference thread
     thread inferenceThread;
 };
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <stddef.h>
+#include <string>
+#include <vector>
 
 namespace Constants {
     static constexpr int max_buf_size = 8192;
@@ -11,4 +13,127 @@ namespace Constants {
     static constexpr int frameBytes = frameWidth * frameHeight * frameNumCh;
     static constexpr int fps = 30;
     static constexpr double target_sr = 16000.0;
+
+    // Upper bound for a runtime analysis size (history ring holds two of these)
+    static constexpr int max_nfft = max_buf_size / 2;
+
+    // Number of hop snapshots buffered between the audio and inference threads
+    // (numHopSlots - 1 hops, ~220 ms at the default hop, survive a slow forward)
+    static constexpr int numHopSlots = 8;
+
+    // Longest audio pass-through delay the renderer can present frames for
+    static constexpr double maxLookaheadMs = 500.0;
+
+    // Bands in the audio-thread envelope filterbank
+    static constexpr int numEnvelopeBands = 16;
+
+    // Destructive interference size used to keep per-thread state apart
+#if defined(__APPLE__) && defined(__aarch64__)
+    static constexpr size_t cacheLineSize = 128;
+#else
+    static constexpr size_t cacheLineSize = 64;
+#endif
 }
+
+// Sample type of the analysis chain (downmix output, resampler state and
+// output, ingest ring). Host buffers of either precision are read directly;
+// define AUTOLUME_DOUBLE_ANALYSIS to carry the chain in double precision.
+#if defined(AUTOLUME_DOUBLE_ANALYSIS)
+using AnalysisSample = double;
+#else
+using AnalysisSample = float;
+#endif
+
+// Spectral stage at the front of the model input
+enum class SpectralFeatures {
+    Spectrum,           // Single nfft-point magnitude spectrum
+    MultiResolution,    // Several FFT sizes merged into the same space
+    ConstantQ           // Geometrically spaced bins from a sparse spectral kernel
+};
+
+// How the spectrum stage combines the hops queued since the previous frame
+enum class HopAggregation {
+    Latest,     // Newest hop only (intermediate hops are skipped)
+    Max,        // Per-bin maximum over the interval
+    Mean,       // Per-bin mean over the interval
+    Flux        // Per-bin positive spectral flux summed over the interval
+};
+
+// How the TorchScript module is executed
+enum class ExecutionMode {
+    Interpreter,    // Regular TorchScript graph executor
+    StaticRuntime   // Frozen graph with out-variant ops and a planned arena (CPU only)
+};
+
+// Per-layer noise fed to the synthesis network
+enum class NoiseMode {
+    Random,     // Fresh randn per layer every frame (checkpoint default)
+    Constant,   // One buffer per layer, generated at load
+    Cycled      // A short bank per layer, stepped through frame by frame
+};
+
+// How a model layer combines with the layers below it
+enum class BlendMode {
+    Normal,     // Cross-fade by opacity
+    Add,        // Sum, clipped to white
+    Multiply,   // Darken
+    Screen      // Lighten
+};
+
+// One extra model composited over the primary model's frame
+struct LayerSettings {
+    BlendMode blendMode = BlendMode::Normal;
+    float opacity = 1.0f;
+    int featureOffset = 0;                               // First model input feature routed to this layer
+    int featureCount = 0;                                // Features routed from featureOffset (0 = all remaining)
+    float latentSpeed = 0.25f;                           // Seed units per second of this layer's latent walk
+    float seedY = 0.0f;                                  // Row of the seed grid the walk travels along
+    int updateInterval = 1;                              // Render at most every N frames (background layers)
+    float priority = 1.0f;                               // Share of the frame budget relative to other layers
+};
+
+// YUV 4:2:0 layouts offered to recording and streaming sinks
+enum class YuvLayout {
+    Nv12,       // Y plane, then one interleaved CbCr plane
+    I420        // Y plane, then Cb and Cr planes
+};
+
+// Hard memory budgets in bytes, 0 for unlimited. Caches evict and pools
+// shrink to stay under them; all are read at model load.
+struct MemoryBudgets {
+    size_t noiseBank = 0;    // Cycled noise frames on the model's device
+    size_t latentCache = 0;  // Seed vectors cached by the latent walk
+    size_t renderSlots = 0;  // Tensors retained by the frame worker slots
+};
+
+// Runtime geometry of the analysis pipeline. Defaults are the compile-time
+// constants above; the rendered frame size is not configured here but
+// discovered from the model's output shape.
+struct PipelineConfig {
+    int nfft = Constants::nfft;                          // Analysis size (power of two, <= max_nfft)
+    double targetSampleRate = Constants::target_sr;      // Analysis sample rate
+    int fps = Constants::fps;                            // Editor refresh / inference request rate
+    SpectralFeatures spectralFeatures = SpectralFeatures::Spectrum;
+    HopAggregation hopAggregation = HopAggregation::Latest;
+    bool chromaFold = false;                             // Append 12 pitch classes to the constant-Q bins
+    bool bandEnvelopes = false;                          // Append audio-thread band envelopes
+    bool slidingDft = false;                             // Append per-sample sliding DFT bins
+    bool pitchFeatures = false;                          // Append YIN pitch and confidence
+    NoiseMode noiseMode = NoiseMode::Random;
+    int noiseCycleLength = 8;                            // Frames per noise cycle in NoiseMode::Cycled
+    ExecutionMode executionMode = ExecutionMode::Interpreter;
+    bool channelsLast = false;                           // Run the conv path NHWC (+ oneDNN fusion on x86), kept only if outputs match
+    bool verifyAccuracy = false;                         // Check the feature stage against double-precision references; configure() rejects a failing config
+    int inferenceWorkers = 1;                            // Frame-parallel forward workers (CPU device, read at thread start)
+    int taskThreads = 0;                                 // Task pool for conversion and compositing (0 = half the cores, read at thread start)
+    double lookaheadMs = 0.0;                            // Delay the audio by this much (reported to the host) and show frames when it is heard
+    bool lockAudioMemory = false;                        // mlock the audio thread's buffers in prepareToPlay (needs RLIMIT_MEMLOCK headroom)
+    bool verifyAudioFaults = false;                      // Count page faults per audio block and report them with the telemetry
+
+    // Cross-instance feature bus
+    bool analysisOnly = false;                           // Publish features at fps without loading a model
+    std::string busPublishName;                          // Publish this instance's features under this name
+    std::vector<std::string> busSubscriptions;           // Streams after the local features, each in an equal fixed slice
+
+    MemoryBudgets memoryBudgets;
+};
@@ -0,0 +1,75 @@
+#include "AudioMemory.h"
+#include <cstdint>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace
+{
+    size_t pageSize()
+    {
+        static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    // mlock wants page-aligned addresses on some systems
+    void pageRange(const AudioMemory::Region& region, void*& start, size_t& length)
+    {
+        const uintptr_t mask = ~static_cast<uintptr_t>(pageSize() - 1);
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(region.data) & mask;
+        const uintptr_t end = reinterpret_cast<uintptr_t>(region.data) + region.bytes;
+        start = reinterpret_cast<void*>(begin);
+        length = end - begin;
+    }
+}
+
+void AudioMemory::prefault(const Region& region)
+{
+    if (region.data == nullptr || region.bytes == 0) {
+        return;
+    }
+
+    const volatile char* bytes = static_cast<const volatile char*>(region.data);
+    const size_t step = pageSize();
+    char sink = 0;
+    for (size_t offset = 0; offset < region.bytes; offset += step) {
+        sink ^= bytes[offset];
+    }
+    sink ^= bytes[region.bytes - 1];
+    (void) sink;
+}
+
+bool AudioMemory::lock(const Region& region)
+{
+    if (region.data == nullptr || region.bytes == 0) {
+        return true;
+    }
+
+    void* start = nullptr;
+    size_t length = 0;
+    pageRange(region, start, length);
+    return mlock(start, length) == 0;
+}
+
+void AudioMemory::unlock(const Region& region)
+{
+    if (region.data == nullptr || region.bytes == 0) {
+        return;
+    }
+
+    void* start = nullptr;
+    size_t length = 0;
+    pageRange(region, start, length);
+    munlock(start, length);
+}
+
+long AudioMemory::pageFaults()
+{
+    struct rusage usage {};
+#ifdef RUSAGE_THREAD
+    getrusage(RUSAGE_THREAD, &usage);
+#else
+    getrusage(RUSAGE_SELF, &usage);
+#endif
+    return usage.ru_minflt + usage.ru_majflt;
+}
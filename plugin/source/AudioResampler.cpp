@@ -1,111 +1,171 @@
-#include "AudioResampler.h"
-#include <cmath>
-#include <algorithm>
-
-AudioResampler::AudioResampler()
-    : AudioFX()
-    , sourceRate(44100.0)
-    , targetRate(16000.0)
-    , resampleRatio(0.0)
-    , timeAccumulator(0.0)
-    , outputBufferSize(0)
-    , lastOutputSampleCount(0)
-{
-    reset();
-}
-
-void AudioResampler::initialize(double sampleRate)
-{
-    AudioFX::initialize(sampleRate);
-    sourceRate = sampleRate;
-    targetRate = 16000.0;
-    resampleRatio = targetRate / sourceRate;
-    reset();
-}
-
-void AudioResampler::reset()
-{
-    AudioFX::reset();
-    // Clear FIR filter delay line
-    std::memset(delayLine, 0, FIR_NUM_TAPS * sizeof(float));
-    delayIndex = 0;
-    timeAccumulator = 0.0;
-    prevFilteredSample = 0.0f;
-    currFilteredSample = 0.0f;
-}
-
-int AudioResampler::resample(float *in, float *out, int numSamples)
-{
-    int outputSampleCount = 0;
-
-    for (int i = 0; i < numSamples; ++i) {
-        // Apply FIR anti-aliasing filter
-        float filteredSample = applyFIR(in[i]);
-
-        // Linear interpolation resampling
-        currFilteredSample = filteredSample;
-
-        // Accumulate time for resampling
-        timeAccumulator += resampleRatio;
-
-        // Generate output samples when time accumulator >= 1.0
-        while (timeAccumulator >= 1.0) {
-            // Linear interpolation between previous and current sample
-            float frac = static_cast<float>(1.0 - (timeAccumulator - 1.0) / resampleRatio);
-            frac = std::max(0.0f, std::min(1.0f, frac)); // Clamp to [0, 1]
-
-            out[outputSampleCount++] = prevFilteredSample + frac * (currFilteredSample - prevFilteredSample);
-
-            timeAccumulator -= 1.0;
-        }
-
-        prevFilteredSample = currFilteredSample;
-    }
-
-    lastOutputSampleCount = outputSampleCount;
-    return outputSampleCount;
-}
-
-void AudioResampler::apply(float *in, float *out, int numSamples)
-{
-    resample(in, out, numSamples);
-}
-
-float AudioResampler::applyFilterOnly(float inputSample)
-{
-    return applyFIR(inputSample);
-}
-
-int AudioResampler::getExpectedOutputSize(int inputSamples) const
-{
-    return static_cast<int>(std::ceil(inputSamples * resampleRatio));
-}
-
-void AudioResampler::onSampleRateChanged()
-{
-    sourceRate = sampleRate;
-    resampleRatio = targetRate / sourceRate;
-    reset();
-}
-
-float AudioResampler::applyFIR(float inputSample)
-{
-    // Insert new sample into circular delay line
-    delayLine[delayIndex] = inputSample;
-
-    // Compute FIR filter output (convolution)
-    float output = 0.0f;
-    int idx = delayIndex;
-
-    for (int i = 0; i < FIR_NUM_TAPS; ++i) {
-        output += FIR_TAPS[i] * delayLine[idx];
-
-        // Move backward through circular buffer
-        idx = (idx == 0) ? (FIR_NUM_TAPS - 1) : (idx - 1);
-    }
-
-    // Advance delay line index
-    delayIndex = (delayIndex + 1) % FIR_NUM_TAPS;
-
-    return output;
-}
+#include "AudioResampler.h"
+#include <cmath>
+#include <algorithm>
+
+AudioResampler::AudioResampler()
+    : AudioFX()
+    , sourceRate(44100.0)
+    , targetRate(Constants::target_sr)
+    , resampleRatio(0.0)
+    , timeAccumulator(0.0)
+    , outputBufferSize(0)
+    , lastOutputSampleCount(0)
+{
+    designFilter();
+    reset();
+}
+
+void AudioResampler::initialize(double sampleRate)
+{
+    AudioFX::initialize(sampleRate);
+    sourceRate = sampleRate;
+    resampleRatio = targetRate / sourceRate;
+    designFilter();
+    reset();
+}
+
+void AudioResampler::setTargetRate(double newTargetRate)
+{
+    if (newTargetRate <= 0.0 || newTargetRate == targetRate) {
+        return;
+    }
+
+    targetRate = newTargetRate;
+    resampleRatio = targetRate / sourceRate;
+    designFilter();
+    reset();
+}
+
+void AudioResampler::designFilter()
+{
+    // The precomputed table (scripts/verify_fir.py) covers the default rate
+    if (targetRate == Constants::target_sr) {
+        std::copy(FIR_TAPS, FIR_TAPS + FIR_NUM_TAPS, firTaps);
+        return;
+    }
+
+    // Zeroth-order modified Bessel function for the Kaiser window
+    auto besselI0 = [](double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    };
+
+    constexpr double beta = 8.0;
+    const double pi = 3.14159265358979323846;
+    const double cutoff = std::min(0.45 * targetRate, 0.5 * sourceRate) / sourceRate;  // Cycles per sample
+    const double center = 0.5 * (FIR_NUM_TAPS - 1);
+
+    double sum = 0.0;
+    for (int i = 0; i < FIR_NUM_TAPS; ++i) {
+        double n = i - center;
+        double sinc = (n == 0.0) ? 2.0 * cutoff : std::sin(2.0 * pi * cutoff * n) / (pi * n);
+        double r = n / center;
+        double window = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(beta);
+        firTaps[i] = static_cast<AnalysisSample>(sinc * window);
+        sum += sinc * window;
+    }
+
+    // Unity DC gain, as firwin does
+    for (int i = 0; i < FIR_NUM_TAPS; ++i) {
+        firTaps[i] = static_cast<AnalysisSample>(firTaps[i] / sum);
+    }
+}
+
+void AudioResampler::reset()
+{
+    AudioFX::reset();
+    // Clear FIR filter delay line
+    std::memset(delayLine, 0, FIR_NUM_TAPS * sizeof(AnalysisSample));
+    delayIndex = 0;
+    timeAccumulator = 0.0;
+    prevFilteredSample = 0;
+    currFilteredSample = 0;
+}
+
+template <typename InSample, typename OutSample>
+int AudioResampler::resample(const InSample *in, OutSample *out, int numSamples)
+{
+    int outputSampleCount = 0;
+
+    for (int i = 0; i < numSamples; ++i) {
+        // Apply FIR anti-aliasing filter
+        AnalysisSample filteredSample = applyFIR(static_cast<AnalysisSample>(in[i]));
+
+        // Linear interpolation resampling
+        currFilteredSample = filteredSample;
+
+        // Accumulate time for resampling
+        timeAccumulator += resampleRatio;
+
+        // Generate output samples when time accumulator >= 1.0
+        while (timeAccumulator >= 1.0) {
+            // Linear interpolation between previous and current sample
+            auto frac = static_cast<AnalysisSample>(1.0 - (timeAccumulator - 1.0) / resampleRatio);
+            frac = std::max<AnalysisSample>(0, std::min<AnalysisSample>(1, frac)); // Clamp to [0, 1]
+
+            out[outputSampleCount++] = static_cast<OutSample>(prevFilteredSample + frac * (currFilteredSample - prevFilteredSample));
+
+            timeAccumulator -= 1.0;
+        }
+
+        prevFilteredSample = currFilteredSample;
+    }
+
+    lastOutputSampleCount = outputSampleCount;
+    return outputSampleCount;
+}
+
+void AudioResampler::apply(float *in, float *out, int numSamples)
+{
+    resample(in, out, numSamples);
+}
+
+AnalysisSample AudioResampler::applyFilterOnly(AnalysisSample inputSample)
+{
+    return applyFIR(inputSample);
+}
+
+int AudioResampler::getExpectedOutputSize(int inputSamples) const
+{
+    return static_cast<int>(std::ceil(inputSamples * resampleRatio));
+}
+
+void AudioResampler::onSampleRateChanged()
+{
+    sourceRate = sampleRate;
+    resampleRatio = targetRate / sourceRate;
+    designFilter();
+    reset();
+}
+
+AnalysisSample AudioResampler::applyFIR(AnalysisSample inputSample)
+{
+    // Insert new sample into circular delay line
+    delayLine[delayIndex] = inputSample;
+
+    // Compute FIR filter output (convolution)
+    AnalysisSample output = 0;
+    int idx = delayIndex;
+
+    for (int i = 0; i < FIR_NUM_TAPS; ++i) {
+        output += firTaps[i] * delayLine[idx];
+
+        // Move backward through circular buffer
+        idx = (idx == 0) ? (FIR_NUM_TAPS - 1) : (idx - 1);
+    }
+
+    // Advance delay line index
+    delayIndex = (delayIndex + 1) % FIR_NUM_TAPS;
+
+    return output;
+}
+
+// Host buffers may be float or double; the analysis side is AnalysisSample
+template int AudioResampler::resample<float, float>(const float*, float*, int);
+template int AudioResampler::resample<float, double>(const float*, double*, int);
+template int AudioResampler::resample<double, float>(const double*, float*, int);
+template int AudioResampler::resample<double, double>(const double*, double*, int);
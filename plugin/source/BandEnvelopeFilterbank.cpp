@@ -0,0 +1,85 @@
+#include "BandEnvelopeFilterbank.h"
+#include <algorithm>
+#include <cmath>
+
+template <int NumBands>
+void BandEnvelopeFilterbank<NumBands>::prepare(double sampleRate)
+{
+    const double pi = 3.14159265358979323846;
+    const double lowHz = 40.0;
+    const double highHz = 0.42 * sampleRate;
+    const double spacing = std::pow(highHz / lowHz, 1.0 / (NumBands - 1));  // Ratio between neighbours
+
+    // One band-spacing wide: Q = sqrt(r) / (r - 1)
+    const double q = std::sqrt(spacing) / (spacing - 1.0);
+
+    for (int b = 0; b < NumBands; b++) {
+        double fc = lowHz * std::pow(spacing, b);
+        double w0 = 2.0 * pi * fc / sampleRate;
+        double alpha = std::sin(w0) / (2.0 * q);
+        double a0 = 1.0 + alpha;
+
+        centreHz[b] = static_cast<float>(fc);
+        b0[b] = static_cast<float>(alpha / a0);
+        b2[b] = static_cast<float>(-alpha / a0);   // b1 is zero for this band-pass
+        a1[b] = static_cast<float>(-2.0 * std::cos(w0) / a0);
+        a2[b] = static_cast<float>((1.0 - alpha) / a0);
+    }
+
+    // 1 ms attack, 60 ms release
+    attack = static_cast<float>(1.0 - std::exp(-1.0 / (0.001 * sampleRate)));
+    release = static_cast<float>(1.0 - std::exp(-1.0 / (0.060 * sampleRate)));
+    publishInterval = std::max(1, static_cast<int>(sampleRate * 0.0005));
+
+    reset();
+}
+
+template <int NumBands>
+void BandEnvelopeFilterbank<NumBands>::reset()
+{
+    z1.fill(0.0f);
+    z2.fill(0.0f);
+    env.fill(0.0f);
+    publishCounter = 0;
+    for (auto& value : published) {
+        value.store(0.0f, std::memory_order_relaxed);
+    }
+}
+
+template <int NumBands>
+void BandEnvelopeFilterbank<NumBands>::process(float x)
+{
+    std::array<float, NumBands> y;
+
+    // Biquads across bands
+    for (int b = 0; b < NumBands; b++) {
+        y[b] = b0[b] * x + z1[b];
+        z1[b] = -a1[b] * y[b] + z2[b];
+        z2[b] = b2[b] * x - a2[b] * y[b];
+    }
+
+    // Envelope followers (branchless attack/release select)
+    for (int b = 0; b < NumBands; b++) {
+        float rectified = std::fabs(y[b]);
+        float coeff = rectified > env[b] ? attack : release;
+        env[b] += coeff * (rectified - env[b]);
+    }
+
+    if (++publishCounter >= publishInterval) {
+        publishCounter = 0;
+        for (int b = 0; b < NumBands; b++) {
+            published[b].store(env[b], std::memory_order_relaxed);
+        }
+    }
+}
+
+template <int NumBands>
+void BandEnvelopeFilterbank<NumBands>::getEnvelopes(float* dest) const
+{
+    for (int b = 0; b < NumBands; b++) {
+        dest[b] = published[b].load(std::memory_order_relaxed);
+    }
+}
+
+template class BandEnvelopeFilterbank<8>;
+template class BandEnvelopeFilterbank<16>;
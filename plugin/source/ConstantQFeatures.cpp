@@ -0,0 +1,155 @@
+#include "ConstantQFeatures.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double referenceC2 = 65.40639132514966;  // Hz
+    constexpr float kernelThreshold = 0.01f;           // Relative to each kernel's peak
+}
+
+ConstantQFeatures::ConstantQFeatures(bool withChroma, int binsPerOctave, int fftSize)
+    : withChroma(withChroma)
+    , binsPerOctave(std::max(12, binsPerOctave - binsPerOctave % 12))
+    , fftSize(std::min(fftSize, Constants::max_nfft))
+{
+}
+
+void ConstantQFeatures::prepare(const AnalysisContext& context)
+{
+    fftSetup = context.fftSetup;
+    log2n = static_cast<vDSP_Length>(std::log2(fftSize));
+    fftReal.allocate(fftSize / 2);
+    fftImag.allocate(fftSize / 2);
+
+    buildKernel(context);
+    magnitudes.allocate(std::max(numBins, 1));
+}
+
+void ConstantQFeatures::buildKernel(const AnalysisContext& context)
+{
+    const double sr = context.sampleRate;
+    const double q = 1.0 / (std::pow(2.0, 1.0 / binsPerOctave) - 1.0);
+
+    // Lowest bin whose kernel still fits in the FFT, kept on the C2 grid so
+    // pitch classes line up with the chroma fold
+    double lowest = std::max(referenceC2, q * sr / fftSize);
+    double stepsAboveC2 = std::ceil(binsPerOctave * std::log2(lowest / referenceC2) - 1e-9);
+    minFrequency = static_cast<float>(referenceC2 * std::pow(2.0, stepsAboveC2 / binsPerOctave));
+
+    // Stay inside the spectral budget and below the resampler's cutoff
+    const double maxFrequency = 0.45 * sr;
+    int maxBins = context.nfft / 2 - (withChroma ? 12 : 0);
+    numBins = static_cast<int>(std::floor(binsPerOctave * std::log2(maxFrequency / minFrequency))) + 1;
+    numBins = std::clamp(numBins, 0, std::max(maxBins, 0));
+
+    kernelStart.assign(numBins, 0);
+    kernelLength.assign(numBins, 0);
+    kernelOffset.assign(numBins, 0);
+    pitchClass.assign(numBins, 0);
+
+    // Temporal kernels are transformed with a full complex FFT of size N
+    const int n = fftSize;
+    const int half = n / 2;
+    AlignedBuffer<float> re(n), im(n);
+    DSPSplitComplex split{re.data(), im.data()};
+
+    std::vector<float> bandReal, bandImag;
+    for (int k = 0; k < numBins; k++) {
+        double freq = minFrequency * std::pow(2.0, static_cast<double>(k) / binsPerOctave);
+        int length = std::min(n, static_cast<int>(std::ceil(q * sr / freq)));
+        int offset = (n - length) / 2;  // Centre the kernel in the frame
+
+        std::fill(re.begin(), re.end(), 0.0f);
+        std::fill(im.begin(), im.end(), 0.0f);
+        for (int i = 0; i < length; i++) {
+            double window = 0.54 - 0.46 * std::cos(2.0 * pi * i / std::max(length - 1, 1));  // Hamming
+            double phase = 2.0 * pi * q * i / length;
+            re[offset + i] = static_cast<float>(window / length * std::cos(phase));
+            im[offset + i] = static_cast<float>(window / length * std::sin(phase));
+        }
+        vDSP_fft_zip(fftSetup, &split, 1, log2n, FFT_FORWARD);
+
+        // Keep the contiguous band of positive-frequency bins above threshold
+        float peak = 0.0f;
+        for (int j = 1; j < half; j++) {
+            peak = std::max(peak, std::hypot(re[j], im[j]));
+        }
+        int start = half, end = 1;
+        for (int j = 1; j < half; j++) {
+            if (std::hypot(re[j], im[j]) >= kernelThreshold * peak) {
+                start = std::min(start, j);
+                end = std::max(end, j + 1);
+            }
+        }
+        if (start >= end) {
+            start = 1;
+            end = 2;
+        }
+
+        kernelStart[k] = start;
+        kernelLength[k] = end - start;
+        kernelOffset[k] = static_cast<int>(bandReal.size());
+        const float scale = 1.0f / (2.0f * n);
+        for (int j = start; j < end; j++) {
+            bandReal.push_back(re[j] * scale);
+            bandImag.push_back(-im[j] * scale);  // Conjugate
+        }
+
+        // Bins per semitone = binsPerOctave / 12; minFrequency sits on the C2 grid
+        int semitone = static_cast<int>(std::lround((stepsAboveC2 + k) * 12.0 / binsPerOctave));
+        pitchClass[k] = ((semitone % 12) + 12) % 12;
+    }
+
+    kernelReal.allocate(std::max<size_t>(bandReal.size(), 1));
+    kernelImag.allocate(std::max<size_t>(bandImag.size(), 1));
+    std::copy(bandReal.begin(), bandReal.end(), kernelReal.begin());
+    std::copy(bandImag.begin(), bandImag.end(), kernelImag.begin());
+}
+
+void ConstantQFeatures::process(const float* history, int historySize, uint64_t hopIndex, float* features)
+{
+    (void) hopIndex;
+    const float* frame = history + historySize - fftSize;
+
+    // One real FFT per hop
+    DSPSplitComplex split{fftReal.data(), fftImag.data()};
+    vDSP_ctoz(reinterpret_cast<const DSPComplex*>(frame), 2, &split, 1, fftSize / 2);
+    vDSP_fft_zrip(fftSetup, &split, 1, log2n, FFT_FORWARD);
+
+    // Sparse complex inner product per CQ bin: X . S = (Xr Sr - Xi Si) + i (Xr Si + Xi Sr)
+    for (int k = 0; k < numBins; k++) {
+        const float* xr = fftReal.data() + kernelStart[k];
+        const float* xi = fftImag.data() + kernelStart[k];
+        const float* sr = kernelReal.data() + kernelOffset[k];
+        const float* si = kernelImag.data() + kernelOffset[k];
+        const auto len = static_cast<vDSP_Length>(kernelLength[k]);
+
+        float rr, ii, ri, ir;
+        vDSP_dotpr(xr, 1, sr, 1, &rr, len);
+        vDSP_dotpr(xi, 1, si, 1, &ii, len);
+        vDSP_dotpr(xr, 1, si, 1, &ri, len);
+        vDSP_dotpr(xi, 1, sr, 1, &ir, len);
+
+        float re = rr - ii;
+        float im = ri + ir;
+        magnitudes[k] = std::sqrt(re * re + im * im);
+    }
+
+    std::copy(magnitudes.begin(), magnitudes.begin() + numBins, features);
+
+    if (withChroma) {
+        float* chroma = features + numBins;
+        std::fill(chroma, chroma + 12, 0.0f);
+        for (int k = 0; k < numBins; k++) {
+            chroma[pitchClass[k]] += magnitudes[k];
+        }
+
+        float maxValue = *std::max_element(chroma, chroma + 12);
+        if (maxValue > 1e-9f) {
+            float inverse = 1.0f / maxValue;
+            vDSP_vsmul(chroma, 1, &inverse, chroma, 1, 12);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#include "FeatureBus.h"
+#include <algorithm>
+
+void FeatureChannel::publish(const float* features, int newCount)
+{
+    newCount = std::min(newCount, Constants::max_nfft);
+
+    // Odd sequence marks the snapshot as being written
+    uint64_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < newCount; i++) {
+        values[i].store(features[i], std::memory_order_relaxed);
+    }
+    count.store(newCount, std::memory_order_relaxed);
+
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+int FeatureChannel::read(float* dest, int maxCount) const
+{
+    // A snapshot is a few KB, so a writer rarely overlaps more than once
+    constexpr int maxAttempts = 8;
+
+    for (int attempt = 0; attempt < maxAttempts; attempt++) {
+        uint64_t before = sequence.load(std::memory_order_acquire);
+        if (before == 0) {
+            return 0;
+        }
+        if (before & 1) {
+            continue;
+        }
+
+        int n = std::min(count.load(std::memory_order_relaxed), maxCount);
+        for (int i = 0; i < n; i++) {
+            dest[i] = values[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) {
+            return n;
+        }
+    }
+    return 0;
+}
+
+FeatureBus& FeatureBus::instance()
+{
+    static FeatureBus bus;
+    return bus;
+}
+
+std::shared_ptr<FeatureChannel> FeatureBus::channel(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto& entry = channels[name];
+    if (!entry) {
+        entry = std::make_shared<FeatureChannel>();
+    }
+    return entry;
+}
@@ -0,0 +1,121 @@
+#include "LatentProjection.h"
+#include <Accelerate/Accelerate.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+void LatentProjection::setBasis(const float* newBasis, int newLatentDim, int newNumFeatures)
+{
+    latentDim = newLatentDim;
+    numFeatures = newNumFeatures;
+    basis.allocate(static_cast<size_t>(latentDim) * numFeatures);
+    std::copy(newBasis, newBasis + basis.size(), basis.begin());
+
+    for (auto& entry : seedCache) {
+        entry.valid = false;
+    }
+    resizeCache();
+}
+
+void LatentProjection::setCacheBudget(size_t bytes)
+{
+    cacheBudget = bytes;
+    resizeCache();
+}
+
+size_t LatentProjection::getCacheBytes() const
+{
+    size_t bytes = 0;
+    for (const auto& entry : seedCache) {
+        bytes += entry.z.sizeInBytes();
+    }
+    return bytes;
+}
+
+void LatentProjection::resizeCache()
+{
+    size_t capacity = maxCachedSeeds;
+    const size_t entryBytes = static_cast<size_t>(latentDim) * sizeof(float);
+    if (cacheBudget > 0 && entryBytes > 0) {
+        capacity = std::clamp<size_t>(cacheBudget / entryBytes, 1, maxCachedSeeds);
+    }
+
+    // Most recently used first, so shrinking evicts the stale tail
+    std::sort(seedCache.begin(), seedCache.end(), [](const CachedSeed& a, const CachedSeed& b) {
+        return a.valid != b.valid ? a.valid : a.lastUse > b.lastUse;
+    });
+    seedCache.resize(capacity);
+
+    for (auto& entry : seedCache) {
+        if (entry.z.size() != static_cast<size_t>(latentDim)) {
+            entry.valid = false;
+            entry.z.allocate(latentDim);
+        }
+    }
+}
+
+void LatentProjection::clear()
+{
+    latentDim = 0;
+    numFeatures = 0;
+    basis.allocate(0);
+}
+
+void LatentProjection::project(float seedX, float seedY, const float* features, float* latent)
+{
+    // Seed grid corners and bilinear weights
+    const float fx = std::floor(seedX);
+    const float fy = std::floor(seedY);
+    const float tx = seedX - fx;
+    const float ty = seedY - fy;
+    const auto x0 = static_cast<int64_t>(fx);
+    const auto y0 = static_cast<int64_t>(fy);
+
+    // Pair the coordinates into one seed per grid point
+    auto seedAt = [](int64_t x, int64_t y) { return x * 73856093LL ^ y * 19349663LL; };
+
+    const float weights[4] = {(1 - tx) * (1 - ty), tx * (1 - ty), (1 - tx) * ty, tx * ty};
+    const int64_t seeds[4] = {seedAt(x0, y0), seedAt(x0 + 1, y0), seedAt(x0, y0 + 1), seedAt(x0 + 1, y0 + 1)};
+
+    std::fill(latent, latent + latentDim, 0.0f);
+    for (int c = 0; c < 4; c++) {
+        if (weights[c] == 0.0f) {
+            continue;
+        }
+        const float* z = seedVector(seeds[c]);
+        for (int i = 0; i < latentDim; i++) {
+            latent[i] += weights[c] * z[i];
+        }
+    }
+
+    // latent += B * features
+    cblas_sgemv(CblasRowMajor, CblasNoTrans, latentDim, numFeatures,
+                1.0f, basis.data(), numFeatures, features, 1,
+                1.0f, latent, 1);
+}
+
+const float* LatentProjection::seedVector(int64_t seed)
+{
+    useCounter++;
+
+    CachedSeed* victim = &seedCache[0];
+    for (auto& entry : seedCache) {
+        if (entry.valid && entry.seed == seed) {
+            entry.lastUse = useCounter;
+            return entry.z.data();
+        }
+        if (victim->valid && (!entry.valid || entry.lastUse < victim->lastUse)) {
+            victim = &entry;
+        }
+    }
+
+    std::mt19937_64 rng(static_cast<uint64_t>(seed));
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    for (int i = 0; i < latentDim; i++) {
+        victim->z[i] = normal(rng);
+    }
+    victim->seed = seed;
+    victim->valid = true;
+    victim->lastUse = useCounter;
+    return victim->z.data();
+}
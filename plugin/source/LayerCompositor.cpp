@@ -0,0 +1,48 @@
+#include "LayerCompositor.h"
+#include <Accelerate/Accelerate.h>
+
+namespace LayerCompositor
+{
+    void blend(float* base, const float* layer, float* scratch, size_t count, BlendMode mode, float opacity)
+    {
+        const auto n = static_cast<vDSP_Length>(count);
+        const float one = 1.0f;
+        const float half = 0.5f;
+        const float minusHalf = -0.5f;
+
+        // scratch = fully applied blend, computed from the base and the layer
+        const float* blended = scratch;
+        switch (mode) {
+            case BlendMode::Normal:
+                blended = layer;
+                break;
+            case BlendMode::Add:
+                vDSP_vadd(base, 1, layer, 1, scratch, 1, n);
+                vDSP_vsadd(scratch, 1, &one, scratch, 1, n);
+                break;
+            case BlendMode::Multiply:
+                // (ab + a + b - 1) / 2
+                vDSP_vmul(base, 1, layer, 1, scratch, 1, n);
+                vDSP_vadd(scratch, 1, base, 1, scratch, 1, n);
+                vDSP_vadd(scratch, 1, layer, 1, scratch, 1, n);
+                vDSP_vsmsa(scratch, 1, &half, &minusHalf, scratch, 1, n);
+                break;
+            case BlendMode::Screen:
+                // (a + b - ab + 1) / 2
+                vDSP_vmul(base, 1, layer, 1, scratch, 1, n);
+                vDSP_vsub(scratch, 1, base, 1, scratch, 1, n);
+                vDSP_vadd(scratch, 1, layer, 1, scratch, 1, n);
+                vDSP_vsmsa(scratch, 1, &half, &half, scratch, 1, n);
+                break;
+        }
+
+        // base += opacity * (blended - base)
+        vDSP_vintb(base, 1, blended, 1, &opacity, base, 1, n);
+
+        // Only Add leaves the range; later layers must see clipped colour
+        if (mode == BlendMode::Add) {
+            const float low = -1.0f;
+            vDSP_vclip(base, 1, &low, &one, base, 1, n);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#include "LayerScheduler.h"
+#include <algorithm>
+
+void LayerScheduler::reset(int numLayers)
+{
+    layers.assign(static_cast<size_t>(numLayers), Layer{});
+    candidates.reserve(layers.size());
+    scheduled.reserve(layers.size());
+}
+
+void LayerScheduler::addLayer()
+{
+    layers.emplace_back();
+    candidates.reserve(layers.size());
+    scheduled.reserve(layers.size());
+}
+
+void LayerScheduler::setSettings(int layer, const LayerSettings& settings)
+{
+    layers[layer].priority = std::max(settings.priority, 0.0f);
+    layers[layer].updateInterval = std::max(settings.updateInterval, 1);
+}
+
+void LayerScheduler::recordCost(int layer, float micros)
+{
+    // Same smoothing as the feature stage's cost average
+    float& average = layers[layer].costMicros;
+    average = average == 0.0f ? micros : average + 0.05f * (micros - average);
+}
+
+const std::vector<int>& LayerScheduler::schedule(float budgetMicros)
+{
+    candidates.clear();
+    scheduled.clear();
+
+    for (int i = 0; i < static_cast<int>(layers.size()); i++) {
+        auto& layer = layers[i];
+        layer.framesSinceRender++;
+        layer.urgency += layer.priority;
+        if (layer.framesSinceRender >= layer.updateInterval) {
+            candidates.push_back(i);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+        return layers[a].urgency > layers[b].urgency;
+    });
+
+    float remaining = budgetMicros;
+    for (int i : candidates) {
+        auto& layer = layers[i];
+        const bool starved = layer.framesSinceRender >= maxIntervalFactor * layer.updateInterval;
+        if (layer.costMicros > remaining && !starved) {
+            continue;
+        }
+
+        remaining -= layer.costMicros;
+        layer.framesSinceRender = 0;
+        layer.urgency = 0.0f;
+        scheduled.push_back(i);
+    }
+    return scheduled;
+}
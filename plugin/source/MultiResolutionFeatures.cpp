@@ -0,0 +1,128 @@
+#include "MultiResolutionFeatures.h"
+#include <algorithm>
+#include <cmath>
+
+MultiResolutionFeatures::MultiResolutionFeatures()
+    : MultiResolutionFeatures({
+          {4096, 2, 1, 0.0,    500.0,  0.375f},
+          {1024, 1, 1, 500.0,  2000.0, 0.3125f},
+          {256,  1, 2, 2000.0, 1.0e9,  0.3125f},
+      })
+{
+}
+
+MultiResolutionFeatures::MultiResolutionFeatures(std::vector<ResolutionSpec> specs)
+    : specs(std::move(specs))
+{
+}
+
+void MultiResolutionFeatures::prepare(const AnalysisContext& newContext)
+{
+    context = newContext;
+
+    // The merged vector takes the same space as the single spectrum (nfft / 2)
+    const int budget = context.nfft / 2;
+    const double nyquist = 0.5 * context.sampleRate;
+
+    resolutions.clear();
+    resolutions.resize(specs.size());
+    numFeatures = 0;
+    historySize = 0;
+
+    for (size_t r = 0; r < specs.size(); r++) {
+        Resolution& res = resolutions[r];
+        res.spec = specs[r];
+        res.spec.fftSize = std::min(res.spec.fftSize, Constants::max_nfft);
+        res.spec.hopInterval = std::max(1, res.spec.hopInterval);
+        res.spec.subFrames = std::max(1, res.spec.subFrames);
+
+        const int n = res.spec.fftSize;
+        res.log2n = static_cast<vDSP_Length>(std::log2(n));
+
+        // Bin range for this resolution's band
+        const double binHz = context.sampleRate / n;
+        res.firstBin = std::clamp(static_cast<int>(std::floor(res.spec.minHz / binHz)), 0, n / 2 - 1);
+        res.lastBin = std::clamp(static_cast<int>(std::ceil(std::min(res.spec.maxHz, nyquist) / binHz)), res.firstBin + 1, n / 2);
+
+        // The last resolution takes whatever is left of the budget
+        res.numFeatures = (r + 1 == specs.size())
+            ? budget - numFeatures
+            : static_cast<int>(std::round(budget * res.spec.share));
+        res.numFeatures = std::max(0, std::min(res.numFeatures, budget - numFeatures));
+        res.featureOffset = numFeatures;
+        numFeatures += res.numFeatures;
+
+        res.window.allocate(n);
+        vDSP_hann_window(res.window.data(), n, vDSP_HANN_NORM);
+        float windowSum = 0.0f;
+        vDSP_sve(res.window.data(), 1, &windowSum, n);
+        res.scale = windowSum > 0.0f ? 1.0f / windowSum : 1.0f;
+
+        res.frame.allocate(n);
+        res.real.allocate(n / 2);
+        res.imag.allocate(n / 2);
+        res.magnitudes.allocate(n / 2);
+        res.peak.allocate(n / 2);
+        res.computed = false;
+
+        // Staggered sub-windows reach back into the previous hop
+        int span = n + (res.spec.subFrames - 1) * (context.hopSize / res.spec.subFrames);
+        historySize = std::max(historySize, std::min(span, Constants::max_nfft));
+    }
+
+    cachedFeatures.allocate(std::max(numFeatures, 1));
+}
+
+void MultiResolutionFeatures::process(const float* history, int available, uint64_t hopIndex, float* features)
+{
+    for (auto& res : resolutions) {
+        // Long FFTs run at a lower hop rate; reuse their last features in between
+        bool due = !res.computed || hopIndex / res.spec.hopInterval != res.lastHop / res.spec.hopInterval;
+        if (due) {
+            compute(res, history, available);
+            res.lastHop = hopIndex;
+            res.computed = true;
+        }
+    }
+
+    std::copy(cachedFeatures.begin(), cachedFeatures.begin() + numFeatures, features);
+}
+
+void MultiResolutionFeatures::compute(Resolution& res, const float* history, int available)
+{
+    const int n = res.spec.fftSize;
+    const int half = n / 2;
+    const int stride = context.hopSize / res.spec.subFrames;
+    DSPSplitComplex split{res.real.data(), res.imag.data()};
+
+    std::fill(res.peak.begin(), res.peak.end(), 0.0f);
+
+    for (int sub = 0; sub < res.spec.subFrames; sub++) {
+        // Sub-window 0 is the oldest, the last one ends at the newest sample
+        int end = available - (res.spec.subFrames - 1 - sub) * stride;
+        int start = std::max(0, end - n);
+
+        vDSP_vmul(history + start, 1, res.window.data(), 1, res.frame.data(), 1, n);
+        vDSP_ctoz(reinterpret_cast<const DSPComplex*>(res.frame.data()), 2, &split, 1, half);
+        vDSP_fft_zrip(context.fftSetup, &split, 1, res.log2n, FFT_FORWARD);
+
+        // Packed format keeps Nyquist in imag[0]; bin 0 is DC only
+        float nyquist = res.imag[0];
+        res.imag[0] = 0.0f;
+        vDSP_zvabs(&split, 1, res.magnitudes.data(), 1, half);
+        res.imag[0] = nyquist;
+
+        vDSP_vmax(res.magnitudes.data(), 1, res.peak.data(), 1, res.peak.data(), 1, half);
+    }
+
+    // Average-pool the band's bins into this resolution's slice of the vector
+    float* out = cachedFeatures.data() + res.featureOffset;
+    const int numBins = res.lastBin - res.firstBin;
+    for (int f = 0; f < res.numFeatures; f++) {
+        int lo = res.firstBin + (f * numBins) / res.numFeatures;
+        int hi = std::max(lo + 1, res.firstBin + ((f + 1) * numBins) / res.numFeatures);
+        float sum = 0.0f;
+        vDSP_sve(res.peak.data() + lo, 1, &sum, static_cast<vDSP_Length>(hi - lo));
+        out[f] = sum * res.scale / static_cast<float>(hi - lo);
+    }
+}
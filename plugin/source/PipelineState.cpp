@@ -0,0 +1,97 @@
+#include "PipelineState.h"
+
+namespace {
+
+template <typename Enum>
+Enum readEnum(const juce::ValueTree& tree, const juce::Identifier& key, Enum fallback, Enum last) {
+    const int index = static_cast<int>(tree.getProperty(key, static_cast<int>(fallback)));
+    if (index < 0 || index > static_cast<int>(last)) {
+        return fallback;
+    }
+    return static_cast<Enum>(index);
+}
+
+size_t readBytes(const juce::ValueTree& tree, const juce::Identifier& key, size_t fallback) {
+    const auto bytes = static_cast<juce::int64>(tree.getProperty(key, static_cast<juce::int64>(fallback)));
+    return bytes > 0 ? static_cast<size_t>(bytes) : 0;
+}
+
+}
+
+namespace PipelineState {
+
+juce::ValueTree toValueTree(const PipelineConfig& config) {
+    juce::StringArray subscriptions;
+    for (const auto& name : config.busSubscriptions) {
+        subscriptions.add(juce::String(name));
+    }
+
+    juce::ValueTree tree(type);
+    tree.setProperty(Keys::nfft, config.nfft, nullptr);
+    tree.setProperty(Keys::targetSampleRate, config.targetSampleRate, nullptr);
+    tree.setProperty(Keys::fps, config.fps, nullptr);
+    tree.setProperty(Keys::spectralFeatures, static_cast<int>(config.spectralFeatures), nullptr);
+    tree.setProperty(Keys::hopAggregation, static_cast<int>(config.hopAggregation), nullptr);
+    tree.setProperty(Keys::chromaFold, config.chromaFold, nullptr);
+    tree.setProperty(Keys::bandEnvelopes, config.bandEnvelopes, nullptr);
+    tree.setProperty(Keys::slidingDft, config.slidingDft, nullptr);
+    tree.setProperty(Keys::pitchFeatures, config.pitchFeatures, nullptr);
+    tree.setProperty(Keys::noiseMode, static_cast<int>(config.noiseMode), nullptr);
+    tree.setProperty(Keys::noiseCycleLength, config.noiseCycleLength, nullptr);
+    tree.setProperty(Keys::executionMode, static_cast<int>(config.executionMode), nullptr);
+    tree.setProperty(Keys::channelsLast, config.channelsLast, nullptr);
+    tree.setProperty(Keys::verifyAccuracy, config.verifyAccuracy, nullptr);
+    tree.setProperty(Keys::inferenceWorkers, config.inferenceWorkers, nullptr);
+    tree.setProperty(Keys::taskThreads, config.taskThreads, nullptr);
+    tree.setProperty(Keys::lookaheadMs, config.lookaheadMs, nullptr);
+    tree.setProperty(Keys::lockAudioMemory, config.lockAudioMemory, nullptr);
+    tree.setProperty(Keys::verifyAudioFaults, config.verifyAudioFaults, nullptr);
+    tree.setProperty(Keys::analysisOnly, config.analysisOnly, nullptr);
+    tree.setProperty(Keys::busPublishName, juce::String(config.busPublishName), nullptr);
+    tree.setProperty(Keys::busSubscriptions, subscriptions.joinIntoString(", "), nullptr);
+    tree.setProperty(Keys::noiseBankBudget, static_cast<juce::int64>(config.memoryBudgets.noiseBank), nullptr);
+    tree.setProperty(Keys::latentCacheBudget, static_cast<juce::int64>(config.memoryBudgets.latentCache), nullptr);
+    tree.setProperty(Keys::renderSlotsBudget, static_cast<juce::int64>(config.memoryBudgets.renderSlots), nullptr);
+    return tree;
+}
+
+PipelineConfig fromValueTree(const juce::ValueTree& tree) {
+    // Restored XML holds every property as a string; the var conversions
+    // below parse them back
+    PipelineConfig config;
+    config.nfft = tree.getProperty(Keys::nfft, config.nfft);
+    config.targetSampleRate = tree.getProperty(Keys::targetSampleRate, config.targetSampleRate);
+    config.fps = tree.getProperty(Keys::fps, config.fps);
+    config.spectralFeatures = readEnum(tree, Keys::spectralFeatures, config.spectralFeatures, SpectralFeatures::ConstantQ);
+    config.hopAggregation = readEnum(tree, Keys::hopAggregation, config.hopAggregation, HopAggregation::Flux);
+    config.chromaFold = tree.getProperty(Keys::chromaFold, config.chromaFold);
+    config.bandEnvelopes = tree.getProperty(Keys::bandEnvelopes, config.bandEnvelopes);
+    config.slidingDft = tree.getProperty(Keys::slidingDft, config.slidingDft);
+    config.pitchFeatures = tree.getProperty(Keys::pitchFeatures, config.pitchFeatures);
+    config.noiseMode = readEnum(tree, Keys::noiseMode, config.noiseMode, NoiseMode::Cycled);
+    config.noiseCycleLength = tree.getProperty(Keys::noiseCycleLength, config.noiseCycleLength);
+    config.executionMode = readEnum(tree, Keys::executionMode, config.executionMode, ExecutionMode::StaticRuntime);
+    config.channelsLast = tree.getProperty(Keys::channelsLast, config.channelsLast);
+    config.verifyAccuracy = tree.getProperty(Keys::verifyAccuracy, config.verifyAccuracy);
+    config.inferenceWorkers = tree.getProperty(Keys::inferenceWorkers, config.inferenceWorkers);
+    config.taskThreads = tree.getProperty(Keys::taskThreads, config.taskThreads);
+    config.lookaheadMs = tree.getProperty(Keys::lookaheadMs, config.lookaheadMs);
+    config.lockAudioMemory = tree.getProperty(Keys::lockAudioMemory, config.lockAudioMemory);
+    config.verifyAudioFaults = tree.getProperty(Keys::verifyAudioFaults, config.verifyAudioFaults);
+    config.analysisOnly = tree.getProperty(Keys::analysisOnly, config.analysisOnly);
+    config.busPublishName = tree.getProperty(Keys::busPublishName).toString().trim().toStdString();
+
+    const auto subscriptions = juce::StringArray::fromTokens(tree.getProperty(Keys::busSubscriptions).toString(), ",", "");
+    for (const auto& name : subscriptions) {
+        if (name.trim().isNotEmpty()) {
+            config.busSubscriptions.push_back(name.trim().toStdString());
+        }
+    }
+
+    config.memoryBudgets.noiseBank = readBytes(tree, Keys::noiseBankBudget, config.memoryBudgets.noiseBank);
+    config.memoryBudgets.latentCache = readBytes(tree, Keys::latentCacheBudget, config.memoryBudgets.latentCache);
+    config.memoryBudgets.renderSlots = readBytes(tree, Keys::renderSlotsBudget, config.memoryBudgets.renderSlots);
+    return config;
+}
+
+}
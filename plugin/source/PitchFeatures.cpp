@@ -0,0 +1,119 @@
+#include "PitchFeatures.h"
+#include <algorithm>
+#include <cmath>
+
+void PitchFeatures::prepare(const AnalysisContext& context)
+{
+    fftSetup = context.fftSetup;
+    rate = context.sampleRate / decimation;
+
+    // One hop of analysis-rate audio, at least two periods of the lowest pitch
+    windowSize = std::max(context.hopSize / decimation, static_cast<int>(std::ceil(2.0 * rate / minFrequency)));
+    windowSize = std::min(windowSize, Constants::max_nfft / (2 * decimation));
+    minLag = std::max(2, static_cast<int>(std::floor(rate / maxFrequency)));
+    maxLag = std::min(windowSize - 1, static_cast<int>(std::ceil(rate / minFrequency)));
+
+    fftSize = 1;
+    while (fftSize < windowSize + maxLag) {
+        fftSize *= 2;
+    }
+    log2n = static_cast<vDSP_Length>(std::log2(fftSize));
+
+    frame.allocate(fftSize);
+    real.allocate(fftSize / 2);
+    imag.allocate(fftSize / 2);
+    power.allocate(fftSize / 2);
+    correlation.allocate(fftSize);
+    energy.allocate(windowSize + 1);
+    cmnd.allocate(maxLag + 2);
+    lastPitch = 0.0f;
+}
+
+void PitchFeatures::process(const float* history, int historySize, uint64_t hopIndex, float* features)
+{
+    (void) hopIndex;
+    const float* x = history + historySize - windowSize * decimation;
+    const int half = fftSize / 2;
+
+    // Decimate by two (pairwise mean) and zero pad
+    for (int j = 0; j < windowSize; j++) {
+        frame[j] = 0.5f * (x[decimation * j] + x[decimation * j + 1]);
+    }
+    std::fill(frame.begin() + windowSize, frame.end(), 0.0f);
+
+    // Energy prefix sums for the two window terms
+    energy[0] = 0.0;
+    for (int j = 0; j < windowSize; j++) {
+        energy[j + 1] = energy[j] + static_cast<double>(frame[j]) * frame[j];
+    }
+
+    // Autocorrelation = IFFT(|FFT(x)|^2)
+    DSPSplitComplex split{real.data(), imag.data()};
+    vDSP_ctoz(reinterpret_cast<const DSPComplex*>(frame.data()), 2, &split, 1, half);
+    vDSP_fft_zrip(fftSetup, &split, 1, log2n, FFT_FORWARD);
+
+    // Packed bin 0 holds DC (real) and Nyquist (imag), both purely real
+    float dc = real[0] * real[0];
+    float nyquist = imag[0] * imag[0];
+    vDSP_zvmags(&split, 1, power.data(), 1, half);
+    std::copy(power.begin(), power.end(), real.begin());
+    std::fill(imag.begin(), imag.end(), 0.0f);
+    real[0] = dc;
+    imag[0] = nyquist;
+
+    vDSP_fft_zrip(fftSetup, &split, 1, log2n, FFT_INVERSE);
+    vDSP_ztoc(&split, 1, reinterpret_cast<DSPComplex*>(correlation.data()), 2, half);
+
+    // Forward scales by 2 (4 after squaring), inverse by N
+    float scale = 1.0f / (4.0f * fftSize);
+    vDSP_vsmul(correlation.data(), 1, &scale, correlation.data(), 1, fftSize);
+
+    // Difference function and its cumulative mean normalization
+    cmnd[0] = 1.0f;
+    double runningSum = 0.0;
+    for (int tau = 1; tau <= maxLag; tau++) {
+        double head = energy[windowSize - tau];
+        double tail = energy[windowSize] - energy[tau];
+        double d = std::max(0.0, head + tail - 2.0 * correlation[tau]);
+        runningSum += d;
+        cmnd[tau] = runningSum > 0.0 ? static_cast<float>(d * tau / runningSum) : 1.0f;
+    }
+
+    // First dip below the threshold (then its local minimum), else the global minimum
+    int best = -1;
+    for (int tau = minLag; tau <= maxLag; tau++) {
+        if (cmnd[tau] < threshold) {
+            while (tau + 1 <= maxLag && cmnd[tau + 1] < cmnd[tau]) {
+                tau++;
+            }
+            best = tau;
+            break;
+        }
+    }
+    if (best < 0) {
+        best = static_cast<int>(std::min_element(cmnd.begin() + minLag, cmnd.begin() + maxLag + 1) - cmnd.begin());
+    }
+
+    // Parabolic interpolation around the chosen lag
+    double lag = best;
+    if (best > minLag && best < maxLag) {
+        double a = cmnd[best - 1], b = cmnd[best], c = cmnd[best + 1];
+        double denom = a - 2.0 * b + c;
+        if (std::abs(denom) > 1e-12) {
+            lag += 0.5 * (a - c) / denom;
+        }
+    }
+
+    float confidence = std::clamp(1.0f - cmnd[best], 0.0f, 1.0f);
+
+    // Silence has no pitch; hold the last one rather than jumping
+    if (energy[windowSize] > 1e-8) {
+        double f0 = rate / lag;
+        lastPitch = static_cast<float>(std::clamp(std::log2(f0 / minFrequency) / std::log2(maxFrequency / minFrequency), 0.0, 1.0));
+    } else {
+        confidence = 0.0f;
+    }
+
+    features[0] = lastPitch;
+    features[1] = confidence;
+}
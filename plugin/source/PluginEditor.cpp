@@ -1,173 +1,312 @@
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAudioProcessor& p)
-    : AudioProcessorEditor (&p), processorRef (p)
-{
-    juce::ignoreUnused (processorRef);
-    // Make sure that before the constructor has finished, you've set the
-    // editor's size to whatever you need it to be.
-    setSize (Constants::frameWidth*2, Constants::frameHeight);
-    startTimerHz(Constants::fps);
-
-    // Setup upload button
-    uploadButton.setButtonText("Load Model...");
-    uploadButton.onClick = [this]() {
-        auto fileChooser = std::make_shared<juce::FileChooser>(
-            "Select TorchScript Model (.pt)",
-            juce::File(),
-            "*.pt"
-        );
-
-        auto chooserFlags = juce::FileBrowserComponent::openMode |
-                           juce::FileBrowserComponent::canSelectFiles;
-
-        fileChooser->launchAsync(chooserFlags, [this, fileChooser](const juce::FileChooser& fc) {
-            auto file = fc.getResult();
-            if (file != juce::File{}) {
-                std::string path = file.getFullPathName().toStdString();
-                bool success = processorRef.renderer.loadModel(path);
-
-                if (success) {
-                    modelPathLabel.setText(file.getFileName(), juce::dontSendNotification);
-                    noiseSlider.setEnabled(true);
-                    speedSlider.setEnabled(true);
-                } else {
-                    modelPathLabel.setText("Failed to load model", juce::dontSendNotification);
-                    noiseSlider.setEnabled(false);
-                    speedSlider.setEnabled(false);
-                }
-            }
-        });
-    };
-    addAndMakeVisible(uploadButton);
-
-    // Setup model path label
-    modelPathLabel.setText("No model loaded", juce::dontSendNotification);
-    modelPathLabel.setJustificationType(juce::Justification::centred);
-    modelPathLabel.setColour(juce::Label::textColourId, juce::Colours::lightgrey);
-    addAndMakeVisible(modelPathLabel);
-
-    // Setup noise strength slider
-    noiseSlider.setSliderStyle(juce::Slider::LinearVertical);
-    noiseSlider.setRange(0.0, 1.0, 0.01);
-    noiseSlider.setValue(0.0);
-    noiseSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
-    noiseSlider.onValueChange = [this]() {
-        processorRef.renderer.setNoiseStrength(static_cast<float>(noiseSlider.getValue()/10.f));
-    };
-    noiseSlider.setEnabled(false);  // Disabled until model is loaded
-    addAndMakeVisible(noiseSlider);
-
-    noiseLabel.setText("Noise Strength", juce::dontSendNotification);
-    noiseLabel.setJustificationType(juce::Justification::centred);
-    addAndMakeVisible(noiseLabel);
-
-    // Setup latent speed slider
-    speedSlider.setSliderStyle(juce::Slider::LinearVertical);
-    speedSlider.setRange(-5.0, 5.0, 0.01);
-    speedSlider.setValue(0.25);
-    speedSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
-    speedSlider.setSkewFactorFromMidPoint(1.0);
-    speedSlider.onValueChange = [this]() {
-        processorRef.renderer.setLatentSpeed(static_cast<float>(speedSlider.getValue()));
-    };
-    speedSlider.setEnabled(false);
-    addAndMakeVisible(speedSlider);
-
-    speedLabel.setText("Latent Speed", juce::dontSendNotification);
-    speedLabel.setJustificationType(juce::Justification::centred);
-    addAndMakeVisible(speedLabel);
-}
-
-AudioPluginAudioProcessorEditor::~AudioPluginAudioProcessorEditor()
-{
-}
-
-//==============================================================================
-void AudioPluginAudioProcessorEditor::paint (juce::Graphics& g)
-{
-    // Left half: video rendering
-    auto leftHalf = juce::Rectangle<float>(0, 0, (float) Constants::frameWidth, (float) Constants::frameHeight);
-    g.drawImage(image, leftHalf);
-
-    // Right half: GUI controls (blank for now)
-    auto rightHalf = juce::Rectangle<float>((float) Constants::frameWidth, 0,
-                                           (float) Constants::frameWidth, (float) Constants::frameHeight);
-    g.setColour(juce::Colour(0xff2a2a2a));  // Dark grey background
-    g.fillRect(rightHalf);
-}
-
-void AudioPluginAudioProcessorEditor::resized()
-{
-    // Right half of the screen
-    auto rightHalf = getLocalBounds().removeFromRight(Constants::frameWidth);
-
-    int margin = 20;
-
-    // Upload button at the top
-    auto topArea = rightHalf.removeFromTop(80).reduced(margin);
-    auto buttonArea = topArea.removeFromTop(40);
-    uploadButton.setBounds(buttonArea);
-
-    // Model path label below button
-    topArea.removeFromTop(5);  // Small gap
-    auto modelLabelArea = topArea.removeFromTop(30);
-    modelPathLabel.setBounds(modelLabelArea);
-
-    // Position sliders side by side
-    int sliderWidth = 60;
-    int sliderHeight = 300;
-    int sliderSpacing = 40;
-
-    // Noise slider on the left
-    auto noiseSliderArea = rightHalf.withSizeKeepingCentre(sliderWidth, sliderHeight)
-                                    .translated(-sliderWidth/2 - sliderSpacing/2, 0);
-    noiseSlider.setBounds(noiseSliderArea);
-
-    int labelWidth = 150;
-    auto noiseLabelArea = rightHalf.withSizeKeepingCentre(labelWidth, 30)
-                                   .translated(-sliderWidth/2 - sliderSpacing/2, -sliderHeight/2 - 50);
-    noiseLabel.setBounds(noiseLabelArea);
-
-    // Speed slider on the right
-    auto speedSliderArea = rightHalf.withSizeKeepingCentre(sliderWidth, sliderHeight)
-                                    .translated(sliderWidth/2 + sliderSpacing/2, 0);
-    speedSlider.setBounds(speedSliderArea);
-
-    auto speedLabelArea = rightHalf.withSizeKeepingCentre(labelWidth, 30)
-                                   .translated(sliderWidth/2 + sliderSpacing/2, -sliderHeight/2 - 50);
-    speedLabel.setBounds(speedLabelArea);
-}
-
-void AudioPluginAudioProcessorEditor::timerCallback()
-{
-    // Safety check: don't access renderer until it's initialized
-    // This prevents crashes during early initialization
-    if (!processorRef.renderer.isReady()) {
-        return;
-    }
-
-    // Request new inference (will be skipped if already running)
-    processorRef.renderer.requestInference();
-
-    if (processorRef.renderer.getLatestFrame(frameData.data(), frameData.size())) {
-        // Convert RGB data to JUCE Image
-        image = juce::Image(juce::Image::RGB, Constants::frameWidth, Constants::frameHeight, false);
-
-        juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::writeOnly);
-        for (int y = 0; y < Constants::frameHeight; y++) {
-            for (int x = 0; x < Constants::frameWidth; x++) {
-                size_t idx = (y * Constants::frameWidth + x) * 3;
-                uint8_t r = frameData[idx + 0];
-                uint8_t g = frameData[idx + 1];
-                uint8_t b = frameData[idx + 2];
-                bitmap.setPixelColour(x, y, juce::Colour(r, g, b));
-            }
-        }
-
-        // Trigger repaint
-        repaint();
-    }
-}
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAudioProcessor& p)
+    : AudioProcessorEditor (&p), processorRef (p)
+{
+    juce::ignoreUnused (processorRef);
+    // Make sure that before the constructor has finished, you've set the
+    // editor's size to whatever you need it to be.
+    // The video area is fixed at frameWidth x frameHeight; the renderer
+    // scales frames of other sizes to it with the other sinks' sizes.
+    setSize (Constants::frameWidth*2 + settingsWidth, Constants::frameHeight);
+    processorRef.renderer.subscribeSize(Constants::frameWidth, Constants::frameHeight);
+    timerFps = processorRef.getPipelineConfig().fps;
+    startTimerHz(timerFps);
+
+    // Setup upload button
+    uploadButton.setButtonText("Load Model...");
+    uploadButton.onClick = [this]() {
+        auto fileChooser = std::make_shared<juce::FileChooser>(
+            "Select TorchScript Model (.pt)",
+            juce::File(),
+            "*.pt"
+        );
+
+        auto chooserFlags = juce::FileBrowserComponent::openMode |
+                           juce::FileBrowserComponent::canSelectFiles;
+
+        fileChooser->launchAsync(chooserFlags, [this, fileChooser](const juce::FileChooser& fc) {
+            auto file = fc.getResult();
+            if (file != juce::File{}) {
+                std::string path = file.getFullPathName().toStdString();
+                bool success = processorRef.renderer.loadModel(path);
+
+                if (success) {
+                    modelPathLabel.setText(file.getFileName(), juce::dontSendNotification);
+                    noiseSlider.setEnabled(processorRef.renderer.canSetNoiseStrength());
+                    speedSlider.setEnabled(true);
+                } else {
+                    modelPathLabel.setText("Failed to load model", juce::dontSendNotification);
+                    noiseSlider.setEnabled(false);
+                    speedSlider.setEnabled(false);
+                }
+            }
+        });
+    };
+    addAndMakeVisible(uploadButton);
+
+    // Setup model path label
+    modelPathLabel.setText("No model loaded", juce::dontSendNotification);
+    modelPathLabel.setJustificationType(juce::Justification::centred);
+    modelPathLabel.setColour(juce::Label::textColourId, juce::Colours::lightgrey);
+    addAndMakeVisible(modelPathLabel);
+
+    // Setup noise strength slider
+    noiseSlider.setSliderStyle(juce::Slider::LinearVertical);
+    noiseSlider.setRange(0.0, 1.0, 0.01);
+    noiseSlider.setValue(0.0);
+    noiseSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+    noiseSlider.onValueChange = [this]() {
+        processorRef.renderer.setNoiseStrength(static_cast<float>(noiseSlider.getValue()/10.f));
+    };
+    noiseSlider.setEnabled(false);  // Disabled until model is loaded
+    addAndMakeVisible(noiseSlider);
+
+    noiseLabel.setText("Noise Strength", juce::dontSendNotification);
+    noiseLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(noiseLabel);
+
+    // Setup latent speed slider
+    speedSlider.setSliderStyle(juce::Slider::LinearVertical);
+    speedSlider.setRange(-5.0, 5.0, 0.01);
+    speedSlider.setValue(0.25);
+    speedSlider.setTextBoxStyle(juce::Slider::TextBoxBelow, false, 80, 20);
+    speedSlider.setSkewFactorFromMidPoint(1.0);
+    speedSlider.onValueChange = [this]() {
+        processorRef.renderer.setLatentSpeed(static_cast<float>(speedSlider.getValue()));
+    };
+    speedSlider.setEnabled(false);
+    addAndMakeVisible(speedSlider);
+
+    speedLabel.setText("Latent Speed", juce::dontSendNotification);
+    speedLabel.setJustificationType(juce::Justification::centred);
+    addAndMakeVisible(speedLabel);
+
+    // Pipeline settings, applied through the processor as they are edited
+    settings = PipelineState::toValueTree(processorRef.getPipelineConfig());
+    seenConfigChanges = processorRef.getPipelineConfigChanges();
+    settings.addListener(this);
+    addSettingsSections();
+    addAndMakeVisible(settingsPanel);
+}
+
+AudioPluginAudioProcessorEditor::~AudioPluginAudioProcessorEditor()
+{
+    settings.removeListener(this);
+    processorRef.renderer.unsubscribeSize(Constants::frameWidth, Constants::frameHeight);
+    processorRef.renderer.getMemoryAccounting().set(MemoryAccounting::Component::EditorImages, 0);
+}
+
+//==============================================================================
+void AudioPluginAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    // Left half: video rendering
+    auto leftHalf = juce::Rectangle<float>(0, 0, (float) Constants::frameWidth, (float) Constants::frameHeight);
+    g.drawImage(image, leftHalf);
+
+    // Right half: GUI controls, with the settings panel beside them
+    auto rightHalf = juce::Rectangle<float>((float) Constants::frameWidth, 0,
+                                           (float) (Constants::frameWidth + settingsWidth), (float) Constants::frameHeight);
+    g.setColour(juce::Colour(0xff2a2a2a));  // Dark grey background
+    g.fillRect(rightHalf);
+}
+
+void AudioPluginAudioProcessorEditor::resized()
+{
+    auto bounds = getLocalBounds();
+    settingsPanel.setBounds(bounds.removeFromRight(settingsWidth));
+
+    // Right half of the screen
+    auto rightHalf = bounds.removeFromRight(Constants::frameWidth);
+
+    int margin = 20;
+
+    // Upload button at the top
+    auto topArea = rightHalf.removeFromTop(80).reduced(margin);
+    auto buttonArea = topArea.removeFromTop(40);
+    uploadButton.setBounds(buttonArea);
+
+    // Model path label below button
+    topArea.removeFromTop(5);  // Small gap
+    auto modelLabelArea = topArea.removeFromTop(30);
+    modelPathLabel.setBounds(modelLabelArea);
+
+    // Position sliders side by side
+    int sliderWidth = 60;
+    int sliderHeight = 300;
+    int sliderSpacing = 40;
+
+    // Noise slider on the left
+    auto noiseSliderArea = rightHalf.withSizeKeepingCentre(sliderWidth, sliderHeight)
+                                    .translated(-sliderWidth/2 - sliderSpacing/2, 0);
+    noiseSlider.setBounds(noiseSliderArea);
+
+    int labelWidth = 150;
+    auto noiseLabelArea = rightHalf.withSizeKeepingCentre(labelWidth, 30)
+                                   .translated(-sliderWidth/2 - sliderSpacing/2, -sliderHeight/2 - 50);
+    noiseLabel.setBounds(noiseLabelArea);
+
+    // Speed slider on the right
+    auto speedSliderArea = rightHalf.withSizeKeepingCentre(sliderWidth, sliderHeight)
+                                    .translated(sliderWidth/2 + sliderSpacing/2, 0);
+    speedSlider.setBounds(speedSliderArea);
+
+    auto speedLabelArea = rightHalf.withSizeKeepingCentre(labelWidth, 30)
+                                   .translated(sliderWidth/2 + sliderSpacing/2, -sliderHeight/2 - 50);
+    speedLabel.setBounds(speedLabelArea);
+}
+
+void AudioPluginAudioProcessorEditor::addSettingsSections()
+{
+    namespace Keys = PipelineState::Keys;
+    using Components = juce::Array<juce::PropertyComponent*>;
+
+    auto value = [this](const juce::Identifier& key) {
+        return settings.getPropertyAsValue(key, nullptr);
+    };
+    auto toggle = [&value](const juce::Identifier& key, const juce::String& name) -> juce::PropertyComponent* {
+        return new juce::BooleanPropertyComponent(value(key), name, "On");
+    };
+    auto choice = [&value](const juce::Identifier& key, const juce::String& name,
+                           const juce::StringArray& labels, const juce::Array<juce::var>& values) -> juce::PropertyComponent* {
+        return new juce::ChoicePropertyComponent(value(key), name, labels, values);
+    };
+    auto text = [&value](const juce::Identifier& key, const juce::String& name) -> juce::PropertyComponent* {
+        return new juce::TextPropertyComponent(value(key), name, 256, false);
+    };
+
+    const juce::StringArray budgetLabels { "Unlimited", "64 MB", "256 MB", "1 GB" };
+    const juce::Array<juce::var> budgetValues { juce::var((juce::int64) 0), juce::var((juce::int64) 64 << 20),
+                                                juce::var((juce::int64) 256 << 20), juce::var((juce::int64) 1 << 30) };
+
+    settingsPanel.addSection("Analysis", Components {
+        choice(Keys::nfft, "FFT size", { "256", "512", "1024", "2048", "4096" }, { 256, 512, 1024, 2048, 4096 }),
+        choice(Keys::targetSampleRate, "Analysis rate", { "8 kHz", "16 kHz", "22.05 kHz", "32 kHz" },
+               { 8000.0, 16000.0, 22050.0, 32000.0 }),
+        choice(Keys::fps, "Frame rate", { "15", "24", "30", "60" }, { 15, 24, 30, 60 }),
+        choice(Keys::lookaheadMs, "Lookahead", { "Off", "50 ms", "100 ms", "200 ms", "500 ms" },
+               { 0.0, 50.0, 100.0, 200.0, 500.0 }),
+    });
+
+    settingsPanel.addSection("Features", Components {
+        choice(Keys::spectralFeatures, "Spectrum", { "Single FFT", "Multi-resolution", "Constant-Q" }, { 0, 1, 2 }),
+        choice(Keys::hopAggregation, "Hops per frame", { "Latest", "Max", "Mean", "Flux" }, { 0, 1, 2, 3 }),
+        toggle(Keys::chromaFold, "Chroma"),
+        toggle(Keys::bandEnvelopes, "Band envelopes"),
+        toggle(Keys::slidingDft, "Sliding DFT"),
+        toggle(Keys::pitchFeatures, "Pitch"),
+        toggle(Keys::verifyAccuracy, "Verify accuracy"),
+    });
+
+    // Read when a model loads or the inference thread starts
+    settingsPanel.addSection("Model", Components {
+        choice(Keys::noiseMode, "Noise", { "Random", "Constant", "Cycled" }, { 0, 1, 2 }),
+        choice(Keys::noiseCycleLength, "Noise cycle", { "4", "8", "16", "32" }, { 4, 8, 16, 32 }),
+        choice(Keys::executionMode, "Execution", { "Interpreter", "Static Runtime" }, { 0, 1 }),
+        toggle(Keys::channelsLast, "Channels last"),
+        choice(Keys::inferenceWorkers, "Workers", { "1", "2", "3", "4" }, { 1, 2, 3, 4 }),
+        choice(Keys::taskThreads, "Task threads", { "Auto", "1", "2", "4", "8" }, { 0, 1, 2, 4, 8 }),
+    });
+
+    settingsPanel.addSection("Feature bus", Components {
+        toggle(Keys::analysisOnly, "Analysis only"),
+        text(Keys::busPublishName, "Publish as"),
+        text(Keys::busSubscriptions, "Subscribe to"),
+    });
+
+    settingsPanel.addSection("Memory", Components {
+        toggle(Keys::lockAudioMemory, "Lock audio memory"),
+        toggle(Keys::verifyAudioFaults, "Count audio faults"),
+        choice(Keys::noiseBankBudget, "Noise bank", budgetLabels, budgetValues),
+        choice(Keys::latentCacheBudget, "Latent cache", budgetLabels, budgetValues),
+        choice(Keys::renderSlotsBudget, "Render slots", budgetLabels, budgetValues),
+    }, false);
+}
+
+void AudioPluginAudioProcessorEditor::valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&)
+{
+    if (! syncingSettings) {
+        applySettings();
+    }
+}
+
+void AudioPluginAudioProcessorEditor::applySettings()
+{
+    if (! processorRef.setPipelineConfig(PipelineState::fromValueTree(settings))) {
+        modelPathLabel.setText("Settings rejected, see log", juce::dontSendNotification);
+    }
+
+    // A rejected change snaps back to the config still in use
+    syncSettings();
+}
+
+void AudioPluginAudioProcessorEditor::syncSettings()
+{
+    const auto& config = processorRef.getPipelineConfig();
+    seenConfigChanges = processorRef.getPipelineConfigChanges();
+
+    syncingSettings = true;
+    settings.copyPropertiesFrom(PipelineState::toValueTree(config), nullptr);
+    syncingSettings = false;
+
+    if (config.fps != timerFps) {
+        timerFps = config.fps;
+        startTimerHz(timerFps);
+    }
+}
+
+void AudioPluginAudioProcessorEditor::timerCallback()
+{
+    // The host may have restored a saved state
+    if (processorRef.getPipelineConfigChanges() != seenConfigChanges) {
+        syncSettings();
+    }
+
+    // Safety check: don't access renderer until it's initialized
+    // This prevents crashes during early initialization
+    if (!processorRef.renderer.isReady()) {
+        return;
+    }
+
+    // Request new inference (will be skipped if already running)
+    processorRef.renderer.requestInference();
+
+    // A Static Runtime build on the inference thread freezes the noise
+    // strengths after the model has loaded
+    const bool noiseAdjustable = processorRef.renderer.canSetNoiseStrength();
+    if (noiseSlider.isEnabled() != noiseAdjustable) {
+        noiseSlider.setEnabled(noiseAdjustable);
+    }
+
+    // Frames arrive at the size of the video area, whatever the model renders
+    const int frameWidth = Constants::frameWidth;
+    const int frameHeight = Constants::frameHeight;
+    frameData.resize(static_cast<size_t>(Constants::frameBytes));
+
+    if (processorRef.renderer.getLatestFrame(frameWidth, frameHeight, frameData.data(), frameData.size())) {
+        // Convert RGB data to JUCE Image
+        if (! image.isValid() || image.getWidth() != frameWidth || image.getHeight() != frameHeight) {
+            image = juce::Image(juce::Image::RGB, frameWidth, frameHeight, false);
+
+            // The frame copy plus the image's own RGB pixels
+            processorRef.renderer.getMemoryAccounting().set(MemoryAccounting::Component::EditorImages,
+                                                            frameData.size() + static_cast<size_t>(frameWidth) * frameHeight * 3);
+        }
+
+        juce::Image::BitmapData bitmap(image, juce::Image::BitmapData::writeOnly);
+        for (int y = 0; y < frameHeight; y++) {
+            for (int x = 0; x < frameWidth; x++) {
+                size_t idx = (static_cast<size_t>(y) * frameWidth + x) * 3;
+                uint8_t r = frameData[idx + 0];
+                uint8_t g = frameData[idx + 1];
+                uint8_t b = frameData[idx + 2];
+                bitmap.setPixelColour(x, y, juce::Colour(r, g, b));
+            }
+        }
+
+        // Trigger repaint
+        repaint();
+    }
+}
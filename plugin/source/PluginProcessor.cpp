@@ -1,202 +1,355 @@
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-AudioPluginAudioProcessor::AudioPluginAudioProcessor()
-     : AudioProcessor (BusesProperties()
-                     #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                      #endif
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     #endif
-                       )
-{
-}
-
-AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
-{
-}
-
-//==============================================================================
-const juce::String AudioPluginAudioProcessor::getName() const
-{
-    return JucePlugin_Name;
-}
-
-bool AudioPluginAudioProcessor::acceptsMidi() const
-{
-   #if JucePlugin_WantsMidiInput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool AudioPluginAudioProcessor::producesMidi() const
-{
-   #if JucePlugin_ProducesMidiOutput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool AudioPluginAudioProcessor::isMidiEffect() const
-{
-   #if JucePlugin_IsMidiEffect
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-double AudioPluginAudioProcessor::getTailLengthSeconds() const
-{
-    return 0.0;
-}
-
-int AudioPluginAudioProcessor::getNumPrograms()
-{
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
-}
-
-int AudioPluginAudioProcessor::getCurrentProgram()
-{
-    return 0;
-}
-
-void AudioPluginAudioProcessor::setCurrentProgram (int index)
-{
-    juce::ignoreUnused (index);
-}
-
-const juce::String AudioPluginAudioProcessor::getProgramName (int index)
-{
-    juce::ignoreUnused (index);
-    return {};
-}
-
-void AudioPluginAudioProcessor::changeProgramName (int index, const juce::String& newName)
-{
-    juce::ignoreUnused (index, newName);
-}
-
-//==============================================================================
-void AudioPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
-{
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
-
-    // Initialize the Autolume renderer (model loading, GPU setup, thread start)
-    renderer.initialize();
-
-    // Initialize the downsampler (44.1 kHz -> 16 kHz)
-    downsampler.initialize(sampleRate);
-
-    // Initialize the reconstruction filter (operates at 44.1 kHz)
-    reconstructionFilter.initialize(sampleRate);
-
-    // Allocate buffers
-    upsampledBuffer.resize(samplesPerBlock);
-
-    // Calculate expected output size for resampled buffer
-    int expectedResampledSize = downsampler.getExpectedOutputSize(samplesPerBlock);
-    resampledBuffer.resize(expectedResampledSize + 64); // Extra padding for safety
-}
-
-void AudioPluginAudioProcessor::releaseResources()
-{
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
-}
-
-bool AudioPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
-{
-  #if JucePlugin_IsMidiEffect
-    juce::ignoreUnused (layouts);
-    return true;
-  #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-
-    // This checks if the input layout matches the output layout
-   #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-   #endif
-
-    return true;
-  #endif
-}
-
-void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
-                                              juce::MidiBuffer& midiMessages)
-{
-    juce::ignoreUnused (midiMessages);
-
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
-
-    // Clear any output channels that didn't have corresponding input channels
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
-
-    int numSamples = buffer.getNumSamples();
-
-    // Mix to mono (average left and right channels)
-    auto* leftData = buffer.getReadPointer(0);
-    auto* rightData = totalNumInputChannels > 1 ? buffer.getReadPointer(1) : leftData;
-
-    for (int s = 0; s < numSamples; ++s) {
-        monoBuffer[s] = 0.5f * (leftData[s] + rightData[s]);
-    }
-
-    // Step 1: Apply anti-aliasing filter and downsample from 44.1 kHz to 16 kHz
-    int numResampledSamples = downsampler.resample(monoBuffer.data(), resampledBuffer.data(), numSamples);
-
-    for (int s = 0; s < numResampledSamples; s++) {
-        renderer.processAudio(resampledBuffer[s]);
-    }
-}
-
-//==============================================================================
-bool AudioPluginAudioProcessor::hasEditor() const
-{
-    return true; // (change this to false if you choose to not supply an editor)
-}
-
-juce::AudioProcessorEditor* AudioPluginAudioProcessor::createEditor()
-{
-    return new AudioPluginAudioProcessorEditor (*this);
-}
-
-//==============================================================================
-void AudioPluginAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
-{
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    juce::ignoreUnused (destData);
-}
-
-void AudioPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
-{
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-    juce::ignoreUnused (data, sizeInBytes);
-}
-
-//==============================================================================
-// This creates new instances of the plugin..
-juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
-{
-    return new AudioPluginAudioProcessor();
-}
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+AudioPluginAudioProcessor::AudioPluginAudioProcessor()
+     : AudioProcessor (BusesProperties()
+                     #if ! JucePlugin_IsMidiEffect
+                      #if ! JucePlugin_IsSynth
+                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                      #endif
+                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                     #endif
+                       )
+{
+}
+
+AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
+{
+    unlockAudioMemory();
+}
+
+//==============================================================================
+const juce::String AudioPluginAudioProcessor::getName() const
+{
+    return JucePlugin_Name;
+}
+
+bool AudioPluginAudioProcessor::acceptsMidi() const
+{
+   #if JucePlugin_WantsMidiInput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool AudioPluginAudioProcessor::producesMidi() const
+{
+   #if JucePlugin_ProducesMidiOutput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool AudioPluginAudioProcessor::isMidiEffect() const
+{
+   #if JucePlugin_IsMidiEffect
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+double AudioPluginAudioProcessor::getTailLengthSeconds() const
+{
+    return 0.0;
+}
+
+int AudioPluginAudioProcessor::getNumPrograms()
+{
+    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                // so this should be at least 1, even if you're not really implementing programs.
+}
+
+int AudioPluginAudioProcessor::getCurrentProgram()
+{
+    return 0;
+}
+
+void AudioPluginAudioProcessor::setCurrentProgram (int index)
+{
+    juce::ignoreUnused (index);
+}
+
+const juce::String AudioPluginAudioProcessor::getProgramName (int index)
+{
+    juce::ignoreUnused (index);
+    return {};
+}
+
+void AudioPluginAudioProcessor::changeProgramName (int index, const juce::String& newName)
+{
+    juce::ignoreUnused (index, newName);
+}
+
+//==============================================================================
+void AudioPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    // Use this method as the place to do any pre-playback
+    // initialisation that you need..
+
+    // Initialize the Autolume renderer (model loading, GPU setup, thread start)
+    renderer.initialize();
+    if (!renderer.configure(pipelineConfig))
+        pipelineConfig = renderer.getConfig();
+
+    prepareAudioPath (sampleRate, samplesPerBlock);
+    prepared = true;
+}
+
+void AudioPluginAudioProcessor::prepareAudioPath (double sampleRate, int samplesPerBlock)
+{
+    // Initialize the downsampler (44.1 kHz -> analysis rate, 16 kHz by default)
+    downsampler.setTargetRate(pipelineConfig.targetSampleRate);
+    downsampler.initialize(sampleRate);
+
+    // Initialize the reconstruction filter (operates at 44.1 kHz)
+    reconstructionFilter.initialize(sampleRate);
+
+    // Hold the pass-through back by the lookahead; the host compensates
+    // the delay and the renderer shows frames when their audio is heard
+    const int lookaheadSamples = juce::roundToInt(pipelineConfig.lookaheadMs * 1.0e-3 * sampleRate);
+    lookahead.prepare(getTotalNumOutputChannels(), lookaheadSamples);
+    setLatencySamples(lookaheadSamples);
+
+    // Allocate buffers
+    upsampledBuffer.resize(samplesPerBlock);
+
+    // Calculate expected output size for resampled buffer
+    int expectedResampledSize = downsampler.getExpectedOutputSize(samplesPerBlock);
+    resampledBuffer.resize(expectedResampledSize + 64); // Extra padding for safety
+
+    // Keep page faults off the audio thread
+    prepareAudioMemory(samplesPerBlock);
+}
+
+void AudioPluginAudioProcessor::releaseResources()
+{
+    // When playback stops, you can use this as an opportunity to free up any
+    // spare memory, etc.
+    prepared = false;
+    unlockAudioMemory();
+}
+
+bool AudioPluginAudioProcessor::setPipelineConfig (const PipelineConfig& newConfig)
+{
+    bool accepted = true;
+    if (! prepared)
+    {
+        // prepareToPlay configures the renderer with it
+        pipelineConfig = newConfig;
+    }
+    else
+    {
+        // configure() and the audio path need the audio thread stopped
+        suspendProcessing (true);
+        accepted = renderer.configure (newConfig);
+        pipelineConfig = accepted ? newConfig : renderer.getConfig();
+        prepareAudioPath (getSampleRate(), getBlockSize());
+        suspendProcessing (false);
+    }
+
+    ++pipelineConfigChanges;
+    return accepted;
+}
+
+void AudioPluginAudioProcessor::prepareAudioMemory (int samplesPerBlock)
+{
+    // Buffers may have moved since the last prepare
+    unlockAudioMemory();
+    audioFaultCheck = false;
+
+    // Never-written pages would fault again on their first store
+    monoBuffer.fill(0);
+
+    std::vector<AudioMemory::Region> regions;
+    const AudioMemory::Visitor collect = [&regions](const void* data, size_t bytes) {
+        regions.push_back({data, bytes});
+    };
+    collect(monoBuffer.data(), sizeof(monoBuffer));
+    collect(resampledBuffer.data(), resampledBuffer.size() * sizeof(AnalysisSample));
+    collect(&downsampler, sizeof(downsampler));
+    lookahead.visitMemory(collect);
+    renderer.visitAudioMemory(collect);
+
+    size_t lockedBytes = 0;
+    size_t failedBytes = 0;
+    for (const auto& region : regions) {
+        AudioMemory::prefault(region);
+        if (!pipelineConfig.lockAudioMemory)
+            continue;
+
+        if (AudioMemory::lock(region)) {
+            lockedRegions.push_back(region);
+            lockedBytes += region.bytes;
+        } else {
+            failedBytes += region.bytes;
+        }
+    }
+    if (pipelineConfig.lockAudioMemory)
+        std::cout << "Autolume: Locked " << lockedBytes / 1024 << " KB of audio memory"
+                  << (failedBytes > 0 ? " (" + std::to_string(failedBytes / 1024) + " KB refused, raise RLIMIT_MEMLOCK)" : std::string())
+                  << std::endl;
+
+    if (samplesPerBlock <= 0)
+        return;
+
+    // Run both precisions once (kernels, lazily bound symbols, stack), then
+    // measure a steady-state block. The renderer takes these blocks as
+    // warm-up: it sees only silence, publishes no hops, and the filter,
+    // delay and analysis state they advanced is cleared afterwards.
+    const int numChannels = juce::jmax (getTotalNumInputChannels(), getTotalNumOutputChannels(), 1);
+    juce::AudioBuffer<float> floatBlock (numChannels, samplesPerBlock);
+    juce::AudioBuffer<double> doubleBlock (numChannels, samplesPerBlock);
+    floatBlock.clear();
+    doubleBlock.clear();
+    renderer.beginAudioWarmUp();
+    processBlockImpl (floatBlock);
+    processBlockImpl (doubleBlock);
+
+    floatBlock.clear();
+    const long faultsBefore = AudioMemory::pageFaults();
+    processBlockImpl (floatBlock);
+    const long faults = AudioMemory::pageFaults() - faultsBefore;
+
+    renderer.endAudioWarmUp();
+    downsampler.reset();
+    lookahead.reset();
+
+    // A fault here means processBlock touches memory the regions above miss
+    if (faults > 0)
+        std::cerr << "Autolume: WARNING: audio block after prefault took " << faults
+                  << " page faults; a buffer the audio thread uses is not prefaulted" << std::endl;
+    else
+        std::cout << "Autolume: Audio block after prefault took no page faults" << std::endl;
+    jassert (faults == 0);
+
+    audioFaultCheck = pipelineConfig.verifyAudioFaults;
+}
+
+void AudioPluginAudioProcessor::unlockAudioMemory()
+{
+    for (const auto& region : lockedRegions)
+        AudioMemory::unlock(region);
+    lockedRegions.clear();
+}
+
+bool AudioPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+  #if JucePlugin_IsMidiEffect
+    juce::ignoreUnused (layouts);
+    return true;
+  #else
+    // This is the place where you check if the layout is supported.
+    // In this template code we only support mono or stereo.
+    // Some plugin hosts, such as certain GarageBand versions, will only
+    // load plugins that support stereo bus layouts.
+    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
+     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+        return false;
+
+    // This checks if the input layout matches the output layout
+   #if ! JucePlugin_IsSynth
+    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+        return false;
+   #endif
+
+    return true;
+  #endif
+}
+
+void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
+                                              juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    processBlockImpl (buffer);
+}
+
+void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer,
+                                              juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    processBlockImpl (buffer);
+}
+
+bool AudioPluginAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    // 64-bit hosts hand us their buffers directly instead of converting to float
+    return true;
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::processBlockImpl (juce::AudioBuffer<SampleType>& buffer)
+{
+    juce::ScopedNoDenormals noDenormals;
+    const long faultsBefore = audioFaultCheck ? AudioMemory::pageFaults() : 0;
+    auto totalNumInputChannels  = getTotalNumInputChannels();
+    auto totalNumOutputChannels = getTotalNumOutputChannels();
+
+    // Clear any output channels that didn't have corresponding input channels
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear (i, 0, buffer.getNumSamples());
+
+    int numSamples = buffer.getNumSamples();
+
+    // Mix to mono (average left and right channels), converting straight
+    // into analysis precision
+    auto* leftData = buffer.getReadPointer(0);
+    auto* rightData = totalNumInputChannels > 1 ? buffer.getReadPointer(1) : leftData;
+
+    for (int s = 0; s < numSamples; ++s) {
+        monoBuffer[s] = static_cast<AnalysisSample>(SampleType (0.5) * (leftData[s] + rightData[s]));
+    }
+
+    // Step 1: Apply anti-aliasing filter and downsample from 44.1 kHz to 16 kHz
+    int numResampledSamples = downsampler.resample(monoBuffer.data(), resampledBuffer.data(), numSamples);
+
+    for (int s = 0; s < numResampledSamples; s++) {
+        renderer.processAudio(resampledBuffer[s]);
+    }
+
+    // The renderer has seen this block; the host hears it after the lookahead
+    lookahead.process(buffer.getArrayOfWritePointers(), totalNumOutputChannels, numSamples);
+
+    if (audioFaultCheck)
+        renderer.addAudioPageFaults(AudioMemory::pageFaults() - faultsBefore);
+}
+
+//==============================================================================
+bool AudioPluginAudioProcessor::hasEditor() const
+{
+    return true; // (change this to false if you choose to not supply an editor)
+}
+
+juce::AudioProcessorEditor* AudioPluginAudioProcessor::createEditor()
+{
+    return new AudioPluginAudioProcessorEditor (*this);
+}
+
+//==============================================================================
+void AudioPluginAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+    // The pipeline config is the plugin's whole state
+    if (auto xml = PipelineState::toValueTree (pipelineConfig).createXml())
+        copyXmlToBinary (*xml, destData);
+}
+
+void AudioPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    auto xml = getXmlFromBinary (data, sizeInBytes);
+    if (xml == nullptr)
+        return;
+
+    const auto tree = juce::ValueTree::fromXml (*xml);
+    if (tree.hasType (PipelineState::type))
+        setPipelineConfig (PipelineState::fromValueTree (tree));
+}
+
+//==============================================================================
+// This creates new instances of the plugin..
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+{
+    return new AudioPluginAudioProcessor();
+}
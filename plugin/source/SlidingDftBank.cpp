@@ -0,0 +1,60 @@
+#include "SlidingDftBank.h"
+#include <algorithm>
+#include <cmath>
+
+void SlidingDftBank::prepare(double sampleRate, int newWindowSize)
+{
+    const double pi = 3.14159265358979323846;
+    windowSize = newWindowSize;
+    numBins = 0;
+
+    for (double freq : defaultFrequencies) {
+        if (freq >= 0.5 * sampleRate || numBins == maxBins) {
+            continue;
+        }
+        // Integer bins keep the comb's zeros on the resonator's pole
+        int k = std::max(1, static_cast<int>(std::lround(freq * windowSize / sampleRate)));
+        double w = 2.0 * pi * k / windowSize;
+        rotRe[numBins] = damping * std::cos(w);
+        rotIm[numBins] = damping * std::sin(w);
+        numBins++;
+    }
+
+    dampingN = std::pow(damping, windowSize);
+    outputScale = 2.0 / windowSize;  // |S| of a full-scale sinusoid is N / 2
+
+    reset();
+}
+
+void SlidingDftBank::reset()
+{
+    re.fill(0.0);
+    im.fill(0.0);
+    for (auto& value : published) {
+        value.store(0.0f, std::memory_order_relaxed);
+    }
+}
+
+void SlidingDftBank::process(double x, double xDelayed)
+{
+    const double input = x - dampingN * xDelayed;
+
+    for (int b = 0; b < maxBins; b++) {
+        double nextRe = rotRe[b] * re[b] - rotIm[b] * im[b] + input;
+        double nextIm = rotRe[b] * im[b] + rotIm[b] * re[b];
+        re[b] = nextRe;
+        im[b] = nextIm;
+    }
+
+    for (int b = 0; b < numBins; b++) {
+        published[b].store(static_cast<float>(outputScale * std::sqrt(re[b] * re[b] + im[b] * im[b])),
+                           std::memory_order_relaxed);
+    }
+}
+
+void SlidingDftBank::getMagnitudes(float* dest) const
+{
+    for (int b = 0; b < numBins; b++) {
+        dest[b] = published[b].load(std::memory_order_relaxed);
+    }
+}
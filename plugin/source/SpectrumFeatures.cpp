@@ -0,0 +1,135 @@
+#include "SpectrumFeatures.h"
+#include <algorithm>
+#include <cmath>
+
+void SpectrumFeatures::prepare(const AnalysisContext& context)
+{
+    fftSetup = context.fftSetup;
+    fftSize = context.nfft;
+    fftLog2n = static_cast<vDSP_Length>(std::log2(fftSize));
+    fftReal.allocate(fftSize / 2);
+    fftImag.allocate(fftSize / 2);
+
+    const size_t batchSize = static_cast<size_t>(Constants::numHopSlots) * (fftSize / 2);
+    batchReal.allocate(batchSize);
+    batchImag.allocate(batchSize);
+    batchMagnitudes.allocate(batchSize);
+    previousSpectrum.allocate(fftSize / 2);
+    lastOutput.allocate(fftSize / 2);
+    hasPrevious = false;
+}
+
+void SpectrumFeatures::process(const float* history, int historySize, uint64_t hopIndex, float* features)
+{
+    (void) hopIndex;
+    const float* frame = history + historySize - fftSize;
+
+    // Compute FFT magnitude using Apple Accelerate vDSP
+    // Step 1: Convert real input to split complex format
+    // vDSP expects input as interleaved complex, reinterpret as DSPComplex
+    DSPSplitComplex split{fftReal.data(), fftImag.data()};
+    vDSP_ctoz(reinterpret_cast<const DSPComplex*>(frame), 2, &split, 1, fftSize / 2);
+
+    // Step 2: Perform forward FFT (real-to-complex)
+    vDSP_fft_zrip(fftSetup, &split, 1, fftLog2n, FFT_FORWARD);
+
+    // Step 3: Magnitudes
+    vDSP_zvabs(&split, 1, features, 1, fftSize / 2);
+}
+
+void SpectrumFeatures::processBatch(const float* histories, int stride, int numHops, int historySize,
+                                    uint64_t lastHopIndex, float* features)
+{
+    const int half = fftSize / 2;
+
+    if (aggregation == HopAggregation::Latest) {
+        FeatureExtractor::processBatch(histories, stride, numHops, historySize, lastHopIndex, features);
+        return;
+    }
+
+    // Nothing new since the last frame: repeat the last aggregate
+    if (hasPrevious && lastHopIndex == lastBatchHop) {
+        std::copy(lastOutput.begin(), lastOutput.begin() + half, features);
+        return;
+    }
+
+    // Deinterleave every queued hop into its own split-complex signal
+    numHops = std::min(numHops, Constants::numHopSlots);
+    for (int h = 0; h < numHops; h++) {
+        const float* frame = histories + static_cast<size_t>(h) * stride + historySize - fftSize;
+        DSPSplitComplex signal{batchReal.data() + h * half, batchImag.data() + h * half};
+        vDSP_ctoz(reinterpret_cast<const DSPComplex*>(frame), 2, &signal, 1, half);
+    }
+
+    // One multi-signal FFT for the whole batch
+    DSPSplitComplex batch{batchReal.data(), batchImag.data()};
+    vDSP_fftm_zrip(fftSetup, &batch, 1, half, fftLog2n, numHops, FFT_FORWARD);
+    vDSP_zvabs(&batch, 1, batchMagnitudes.data(), 1, static_cast<vDSP_Length>(numHops) * half);
+
+    // Per-bin reduction over the interval
+    const float* newest = batchMagnitudes.data() + static_cast<size_t>(numHops - 1) * half;
+    switch (aggregation) {
+        case HopAggregation::Max:
+            std::copy(batchMagnitudes.begin(), batchMagnitudes.begin() + half, features);
+            for (int h = 1; h < numHops; h++) {
+                vDSP_vmax(features, 1, batchMagnitudes.data() + h * half, 1, features, 1, half);
+            }
+            break;
+
+        case HopAggregation::Mean: {
+            std::copy(batchMagnitudes.begin(), batchMagnitudes.begin() + half, features);
+            for (int h = 1; h < numHops; h++) {
+                vDSP_vadd(features, 1, batchMagnitudes.data() + h * half, 1, features, 1, half);
+            }
+            float scale = 1.0f / numHops;
+            vDSP_vsmul(features, 1, &scale, features, 1, half);
+            break;
+        }
+
+        case HopAggregation::Flux:
+            std::fill(features, features + half, 0.0f);
+            for (int h = 0; h < numHops; h++) {
+                const float* current = batchMagnitudes.data() + h * half;
+                const float* previous = h > 0 ? current - half : (hasPrevious ? previousSpectrum.data() : current);
+                for (int b = 0; b < half; b++) {
+                    features[b] += std::max(0.0f, current[b] - previous[b]);
+                }
+            }
+            break;
+
+        case HopAggregation::Latest:
+            break;
+    }
+
+    std::copy(newest, newest + half, previousSpectrum.begin());
+    std::copy(features, features + half, lastOutput.begin());
+    lastBatchHop = lastHopIndex;
+    hasPrevious = true;
+}
+
+bool SpectrumFeatures::computeReference(const double* history, int historySize, double* features)
+{
+    const double* frame = history + historySize - fftSize;
+    const int half = fftSize / 2;
+    const double twoPi = 2.0 * M_PI;
+
+    // Direct DFT, matching vDSP's packed real FFT: results are scaled by 2
+    // and bin 0 carries DC (real) and Nyquist (imaginary)
+    for (int k = 0; k < half; k++) {
+        double re = 0.0;
+        double im = 0.0;
+        for (int n = 0; n < fftSize; n++) {
+            double phase = twoPi * static_cast<double>(k) * n / fftSize;
+            re += frame[n] * std::cos(phase);
+            im -= frame[n] * std::sin(phase);
+        }
+        features[k] = 2.0 * std::hypot(re, im);
+    }
+
+    double nyquist = 0.0;
+    for (int n = 0; n < fftSize; n++) {
+        nyquist += (n & 1) ? -frame[n] : frame[n];
+    }
+    features[0] = 2.0 * std::hypot(features[0] / 2.0, nyquist);
+    return true;
+}
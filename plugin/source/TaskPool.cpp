@@ -0,0 +1,202 @@
+#include "TaskPool.h"
+#include <algorithm>
+
+namespace
+{
+    // Which pool and worker the calling thread belongs to
+    thread_local const TaskPool* currentPool = nullptr;
+    thread_local int currentIndex = -1;
+
+    // Bands of one parallelFor count down under the mutex; the last one
+    // wakes the caller
+    struct BandLatch {
+        std::mutex mutex;
+        std::condition_variable done;
+        int remaining = 0;
+    };
+}
+
+void TaskPool::start(int numThreads)
+{
+    stop();
+
+    if (numThreads <= 0) {
+        numThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+    }
+
+    stopping.store(false, std::memory_order_release);
+    for (int i = 0; i < numThreads; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (int i = 0; i < numThreads; i++) {
+        workers[i]->thread = std::thread(&TaskPool::workerLoop, this, i);
+    }
+}
+
+void TaskPool::stop()
+{
+    if (workers.empty()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true, std::memory_order_release);
+    }
+    wake.notify_all();
+
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+    workers.clear();
+}
+
+int TaskPool::currentWorker() const
+{
+    return currentPool == this ? currentIndex : -1;
+}
+
+void TaskPool::submit(std::function<void()> task, Priority priority)
+{
+    if (workers.empty()) {
+        task();
+        return;
+    }
+
+    // Pool threads keep their own work local; others spread it round-robin
+    int target = currentWorker();
+    if (target < 0) {
+        target = static_cast<int>(nextQueue.fetch_add(1, std::memory_order_relaxed) % workers.size());
+    }
+
+    {
+        auto& worker = *workers[target];
+        std::lock_guard<std::mutex> lock(worker.queueMutex);
+        worker.queues[static_cast<int>(priority)].push_back(std::move(task));
+    }
+
+    // Taking sleepMutex orders the increment against a worker about to wait
+    pending.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+}
+
+bool TaskPool::takeTask(int self, std::function<void()>& task)
+{
+    const int numWorkers = static_cast<int>(workers.size());
+
+    for (int priority = 0; priority < numPriorities; priority++) {
+        // Own deque first, newest task (still warm in cache)
+        if (self >= 0) {
+            auto& worker = *workers[self];
+            std::lock_guard<std::mutex> lock(worker.queueMutex);
+            auto& queue = worker.queues[priority];
+            if (!queue.empty()) {
+                task = std::move(queue.back());
+                queue.pop_back();
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        // Then steal the oldest from the others, starting after ourselves
+        for (int offset = 1; offset <= numWorkers; offset++) {
+            const int victim = ((self < 0 ? 0 : self) + offset) % numWorkers;
+            if (victim == self) {
+                continue;
+            }
+            auto& worker = *workers[victim];
+            std::lock_guard<std::mutex> lock(worker.queueMutex);
+            auto& queue = worker.queues[priority];
+            if (!queue.empty()) {
+                task = std::move(queue.front());
+                queue.pop_front();
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool TaskPool::runOne(int self)
+{
+    std::function<void()> task;
+    if (!takeTask(self, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void TaskPool::workerLoop(int index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    while (true) {
+        if (runOne(index)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] {
+            return pending.load(std::memory_order_acquire) > 0 || stopping.load(std::memory_order_acquire);
+        });
+
+        // Queued work is finished before the pool stops
+        if (stopping.load(std::memory_order_acquire) && pending.load(std::memory_order_acquire) == 0) {
+            break;
+        }
+    }
+
+    currentPool = nullptr;
+    currentIndex = -1;
+}
+
+void TaskPool::parallelFor(int count, int grain, const std::function<void(int, int)>& fn, Priority priority)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    // A few bands per thread (the caller included) evens out stragglers
+    const int maxBands = 4 * (getNumThreads() + 1);
+    const int numBands = std::clamp(count / std::max(grain, 1), 1, maxBands);
+    if (numBands == 1 || workers.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    BandLatch latch;
+    latch.remaining = numBands - 1;
+    for (int band = 1; band < numBands; band++) {
+        const int begin = static_cast<int>(static_cast<long long>(band) * count / numBands);
+        const int end = static_cast<int>(static_cast<long long>(band + 1) * count / numBands);
+        submit([&fn, &latch, begin, end] {
+            fn(begin, end);
+            std::lock_guard<std::mutex> lock(latch.mutex);
+            if (--latch.remaining == 0) {
+                latch.done.notify_one();
+            }
+        }, priority);
+    }
+
+    fn(0, count / numBands);
+
+    // Help while there are queued tasks, so nested calls from pool threads
+    // can't stall; once there is nothing left to take, the missing bands
+    // are running on other threads and the caller sleeps until they finish
+    const int self = currentWorker();
+    std::unique_lock<std::mutex> lock(latch.mutex);
+    while (latch.remaining > 0) {
+        lock.unlock();
+        const bool ran = runOne(self);
+        lock.lock();
+        if (!ran) {
+            latch.done.wait(lock, [&latch] { return latch.remaining == 0; });
+        }
+    }
+}
@@ -1,25 +1,46 @@
 #include "autolume.h"
+#include "FrameKernels.h"
+#include "AccuracyMetrics.h"
+#include "SpectrumFeatures.h"
+#include "MultiResolutionFeatures.h"
+#include "ConstantQFeatures.h"
+#include "PitchFeatures.h"
+#include "LayerCompositor.h"
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <dlfcn.h>
+#include <random>
 
 Autolume::Autolume() {
-    // Initialize frame buffers to black
-    frameBuffer[0].fill(0);
-    frameBuffer[1].fill(0);
-    inference_input_buf.fill(0.0f);
-
-    // Initialize FFT setup (512-point FFT, log2(512) = 9)
-    fftLog2n = static_cast<vDSP_Length>(std::log2(Constants::nfft));
+    const auto start = std::chrono::steady_clock::now();
+
+    // Allocate analysis buffers once at their maximum size (zero-filled)
+    hopSlots.allocate(static_cast<size_t>(Constants::numHopSlots + 1) * Constants::max_nfft);  // Plus the warm-up slot
+    analysisHistory.allocate(Constants::max_nfft);
+    queuedHistories.allocate(static_cast<size_t>(Constants::numHopSlots) * Constants::max_nfft);
+    inference_input_buf.allocate(Constants::max_nfft);
+    busScratch.allocate(Constants::max_nfft);
+    in_buf.fill(0);  // The sliding DFT reads samples before they are first written
+    accountFeatureState();
+
+    // Initialize frame buffers to black at the default size until a model reports its own
+    allocateFrameBuffers(Constants::frameWidth, Constants::frameHeight);
+
+    // Initialize FFT setup for the largest supported size; smaller sizes reuse it
+    vDSP_Length fftLog2n = static_cast<vDSP_Length>(std::log2(Constants::max_nfft));
     fftSetup = vDSP_create_fftsetup(fftLog2n, FFT_RADIX2);
-
-    // Setup split complex buffer
-    fftSplit.realp = fftReal.data();
-    fftSplit.imagp = fftImag.data();
+    rebuildFeatureChain(config);
 
     // Initialize latent update timestamp
     lastLatentUpdate = std::chrono::steady_clock::now();
 
     std::cout << "Autolume: FFT setup initialized (log2n=" << fftLog2n << ")" << std::endl;
+
+    // Compare with "Inference engine loaded in": constructing an instance
+    // (plugin scans, fresh inserts) never pays for libtorch
+    float millis = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Autolume: Renderer constructed in " << millis << " ms (inference engine not loaded)" << std::endl;
 }
 
 void Autolume::initialize() {
@@ -36,45 +57,497 @@ void Autolume::initialize() {
     std::cout << "Autolume: Ready for model loading" << std::endl;
 }
 
+bool Autolume::configure(const PipelineConfig& newConfig) {
+    bool isPowerOfTwo = newConfig.nfft > 0 && (newConfig.nfft & (newConfig.nfft - 1)) == 0;
+    if (!isPowerOfTwo || newConfig.nfft < 64 || newConfig.nfft > Constants::max_nfft
+        || newConfig.targetSampleRate <= 0.0 || newConfig.fps <= 0
+        || newConfig.lookaheadMs < 0.0 || newConfig.lookaheadMs > Constants::maxLookaheadMs) {
+        std::cerr << "Autolume: Invalid pipeline config (nfft=" << newConfig.nfft
+                  << ", sr=" << newConfig.targetSampleRate << ", fps=" << newConfig.fps << ")" << std::endl;
+        return false;
+    }
+
+    // The model input tensor is sized from nfft, so it is fixed once a model is loaded
+    if (newConfig.nfft != config.nfft && (modelLoaded.load(std::memory_order_acquire) || getNumLayers() > 0)) {
+        std::cerr << "Autolume: Can't change analysis size after a model is loaded" << std::endl;
+        return false;
+    }
+
+    // An analysis-only instance never holds a model
+    if (newConfig.analysisOnly && modelLoaded.load(std::memory_order_acquire)) {
+        std::cerr << "Autolume: Can't switch to analysis-only with a model loaded" << std::endl;
+        return false;
+    }
+
+    // Leaving analysis-only mode stops its thread; loadModel starts the renderer's
+    if (config.analysisOnly && !newConfig.analysisOnly) {
+        stopInferenceThread();
+    }
+
+    // A feature stage that drifts from its reference would feed the model
+    // wrong inputs, so the previous configuration stays
+    if (newConfig.verifyAccuracy && !verifyFeatureAccuracy(newConfig)) {
+        std::cerr << "Autolume: Feature stage failed its accuracy check, keeping the previous config" << std::endl;
+        return false;
+    }
+    if (newConfig.verifyAccuracy && !verifyFrameKernels()) {
+        std::cerr << "Autolume: YUV conversion failed its accuracy check, keeping the previous config" << std::endl;
+        return false;
+    }
+
+    if (!rebuildFeatureChain(newConfig)) {
+        return false;
+    }
+
+    if (config.analysisOnly && !inferenceThread.joinable()) {
+        inferenceThread = std::thread(&Autolume::analysisThreadLoop, this);
+        std::cout << "Autolume: Analysis-only, publishing to \"" << config.busPublishName << "\"" << std::endl;
+    }
+
+    std::cout << "Autolume: Pipeline configured (nfft=" << config.nfft << ", sr=" << config.targetSampleRate
+              << ", fps=" << config.fps << ")" << std::endl;
+    return true;
+}
+
+PipelineConfig Autolume::getConfig() {
+    std::lock_guard<std::mutex> lock(featureMutex);
+    return config;
+}
+
+void Autolume::connectFeatureBus(const PipelineConfig& newConfig, int numLocalFeatures) {
+    if (busPublication) {
+        busPublication->release();
+        busPublication.reset();
+    }
+    if (!newConfig.busPublishName.empty()) {
+        auto channel = FeatureBus::instance().channel(newConfig.busPublishName);
+        if (channel->claim()) {
+            busPublication = std::move(channel);
+        } else {
+            std::cerr << "Autolume: Feature stream \"" << newConfig.busPublishName
+                      << "\" already has a publisher" << std::endl;
+        }
+    }
+
+    // Streams split what the local features leave evenly (rebuildFeatureChain
+    // has checked each gets at least one value); a longer stream is cut
+    const int numSubscriptions = static_cast<int>(newConfig.busSubscriptions.size());
+    busSliceSize = numSubscriptions > 0 ? (newConfig.nfft - numLocalFeatures) / numSubscriptions : 0;
+    busSubscriptions.clear();
+    for (const auto& name : newConfig.busSubscriptions) {
+        BusSubscription subscription{name, FeatureBus::instance().channel(name), vector<float>(busSliceSize, 0.0f)};
+        reportBusTruncation(subscription);
+        busSubscriptions.push_back(std::move(subscription));
+    }
+}
+
+void Autolume::reportBusTruncation(BusSubscription& subscription) {
+    const int published = subscription.channel->size();
+    if (published > busSliceSize && !subscription.truncationReported) {
+        std::cerr << "Autolume: Feature stream \"" << subscription.name << "\" has " << published
+                  << " values, only the first " << busSliceSize << " fit its slice" << std::endl;
+        subscription.truncationReported = true;
+    }
+}
+
+vector<unique_ptr<FeatureExtractor>> Autolume::makeFeatureChain(const PipelineConfig& newConfig,
+                                                              const BandEnvelopeFilterbank<Constants::numEnvelopeBands>& envelopes,
+                                                              const SlidingDftBank& sliding) const {
+    vector<unique_ptr<FeatureExtractor>> chain;
+    switch (newConfig.spectralFeatures) {
+        case SpectralFeatures::Spectrum:
+            chain.push_back(std::make_unique<SpectrumFeatures>(newConfig.hopAggregation));
+            break;
+        case SpectralFeatures::MultiResolution:
+            chain.push_back(std::make_unique<MultiResolutionFeatures>());
+            break;
+        case SpectralFeatures::ConstantQ:
+            chain.push_back(std::make_unique<ConstantQFeatures>(newConfig.chromaFold));
+            break;
+    }
+
+    // Control-rate band envelopes computed on the audio thread
+    if (newConfig.bandEnvelopes) {
+        chain.push_back(std::make_unique<BandEnvelopeFeatures>(envelopes));
+    }
+
+    // Per-sample sliding DFT bins
+    if (newConfig.slidingDft) {
+        chain.push_back(std::make_unique<SlidingDftFeatures>(sliding));
+    }
+
+    if (newConfig.pitchFeatures) {
+        chain.push_back(std::make_unique<PitchFeatures>());
+    }
+    return chain;
+}
+
+AnalysisContext Autolume::makeAnalysisContext(const PipelineConfig& newConfig) const {
+    AnalysisContext context;
+    context.fftSetup = fftSetup;
+    context.sampleRate = newConfig.targetSampleRate;
+    context.hopSize = newConfig.nfft;
+    context.nfft = newConfig.nfft;
+    return context;
+}
+
+bool Autolume::rebuildFeatureChain(const PipelineConfig& newConfig) {
+    // Build and prepare the new chain off to the side. Its envelope and
+    // sliding DFT stages read the live banks, which the current chain is
+    // still using, so the sliding stage is sized from a probe and the
+    // banks are only re-prepared under the lock.
+    const AnalysisContext context = makeAnalysisContext(newConfig);
+    vector<unique_ptr<FeatureExtractor>> chain = makeFeatureChain(newConfig, bandEnvelopes, slidingDft);
+    SlidingDftBank slidingProbe;
+    slidingProbe.prepare(newConfig.targetSampleRate, newConfig.nfft);
+
+    int numFeatures = 0;
+    int historySize = context.hopSize;
+    for (auto& extractor : chain) {
+        extractor->prepare(context);
+        const bool sliding = dynamic_cast<SlidingDftFeatures*>(extractor.get()) != nullptr;
+        numFeatures += sliding ? slidingProbe.getNumBins() : extractor->getNumFeatures();
+        historySize = std::max(historySize, extractor->getHistorySize());
+    }
+
+    if (numFeatures > newConfig.nfft || historySize > Constants::max_nfft) {
+        std::cerr << "Autolume: Feature layout doesn't fit (" << numFeatures << " features, "
+                  << historySize << " samples of history)" << std::endl;
+        return false;
+    }
+
+    // Every subscribed stream needs at least one value of the input
+    const int numSubscriptions = static_cast<int>(newConfig.busSubscriptions.size());
+    if (numSubscriptions > 0 && (newConfig.nfft - numFeatures) / numSubscriptions == 0) {
+        std::cerr << "Autolume: No room for " << numSubscriptions << " feature streams after "
+                  << numFeatures << " local features (nfft=" << newConfig.nfft << ")" << std::endl;
+        return false;
+    }
+
+    // Swap the chain, banks, bus channels and config in together; the
+    // inference and analysis threads only touch them under featureMutex
+    // (or through the live copies) and the audio thread is stopped
+    {
+        std::lock_guard<std::mutex> lock(featureMutex);
+        slidingDft.prepare(newConfig.targetSampleRate, newConfig.nfft);
+        bandEnvelopes.prepare(newConfig.targetSampleRate);
+        featureChain = std::move(chain);
+        analysisHistorySize = historySize;
+        std::fill(analysisHistory.begin(), analysisHistory.end(), 0.0f);
+        infer.analysisCostMicros.store(0.0f, std::memory_order_relaxed);
+        connectFeatureBus(newConfig, numFeatures);
+        if (&newConfig != &config) {
+            config = newConfig;
+        }
+
+        live.nfft.store(newConfig.nfft, std::memory_order_relaxed);
+        live.fps.store(newConfig.fps, std::memory_order_relaxed);
+        live.lookaheadMs.store(newConfig.lookaheadMs, std::memory_order_relaxed);
+        live.inferenceWorkers.store(newConfig.inferenceWorkers, std::memory_order_relaxed);
+        live.taskThreads.store(newConfig.taskThreads, std::memory_order_relaxed);
+        live.verifyAudioFaults.store(newConfig.verifyAudioFaults, std::memory_order_relaxed);
+    }
+
+    audio.hopSize = context.hopSize;
+    audio.historySize = historySize;
+    audio.cnt = 0;
+    audio.bandEnvelopes = newConfig.bandEnvelopes;
+    audio.slidingDft = newConfig.slidingDft;
+    return true;
+}
+
+int Autolume::getNumFrameBuffers() const {
+    return 3 + static_cast<int>(std::ceil(live.lookaheadMs.load(std::memory_order_relaxed) * 1.0e-3
+                                          * live.fps.load(std::memory_order_relaxed)));
+}
+
+void Autolume::allocateFrameBuffers(int width, int height) {
+    size_t numBytes = static_cast<size_t>(width) * height * Constants::frameNumCh;
+    const int numBuffers = getNumFrameBuffers();
+
+    std::lock_guard<std::mutex> lock(frameMutex);
+    frameBuffers.resize(numBuffers);
+    for (auto& slot : frameBuffers) {
+        slot.rgb.allocate(numBytes);
+        for (int layout = 0; layout < numYuvLayouts; layout++) {
+            slot.yuv[layout].allocate(0);
+            slot.hasYuv[layout] = false;
+        }
+        slot.sized.clear();
+    }
+    yuvFrameBytes.store(0, std::memory_order_relaxed);
+    pyramidLevels.clear();
+    sizedFrameBytes.store(0, std::memory_order_relaxed);
+
+    // Buffer 0 is shown (black) and buffer 1 written; the rest start free
+    shownFrameBuffer = 0;
+    writeFrameIndex = 1;
+    queuedFrames.clear();
+    queuedFrames.reserve(numBuffers);
+    freeFrameBuffers.clear();
+    freeFrameBuffers.reserve(numBuffers);
+    for (int i = numBuffers - 1; i >= 2; i--) {
+        freeFrameBuffers.push_back(i);
+    }
+
+    memory.set(MemoryAccounting::Component::FrameBuffers, numBuffers * numBytes);
+    infer.frameWidth.store(width, std::memory_order_release);
+    infer.frameHeight.store(height, std::memory_order_release);
+}
+
+void Autolume::accountFeatureState() {
+    size_t bytes = sizeof(in_buf) + hopSlots.sizeInBytes() + queuedHistories.sizeInBytes()
+                 + analysisHistory.sizeInBytes() + inference_input_buf.sizeInBytes() + latentBuf.sizeInBytes()
+                 + busScratch.sizeInBytes();
+    for (const auto& worker : workers) {
+        bytes += worker->job.input.sizeInBytes();
+    }
+    memory.set(MemoryAccounting::Component::FeatureState, bytes);
+}
+
+void Autolume::reportMemory() {
+    using Component = MemoryAccounting::Component;
+
+    EngineMemoryUsage usage;
+    if (engine) {
+        engine->getMemoryUsage(usage);
+    }
+    size_t modelBytes = usage.weights + usage.caches;
+    size_t weights = usage.weights + latentProjection.getBasisBytes();
+    size_t activations = usage.activations;
+    size_t caches = usage.caches + latentProjection.getCacheBytes();
+    size_t frames = 0;
+    for (const auto& slot : frameBuffers) {
+        frames += slot.rgb.sizeInBytes();
+    }
+    frames += yuvFrameBytes.load(std::memory_order_relaxed) + sizedFrameBytes.load(std::memory_order_relaxed);
+
+    // Layers are only added or dropped on this thread; workers swap their frames
+    std::unique_lock<std::mutex> layerLock(layerMutex);
+    for (const auto& layer : layers) {
+        EngineMemoryUsage layerUsage;
+        layer->engine->getMemoryUsage(layerUsage);
+        modelBytes += layerUsage.weights + layerUsage.caches;
+        weights += layerUsage.weights + layer->projection.getBasisBytes();
+        activations += layerUsage.activations;
+        caches += layerUsage.caches + layer->projection.getCacheBytes();
+        frames += layer->frame.sizeInBytes();
+    }
+    layerLock.unlock();
+    frames += compositeBuf.sizeInBytes() + compositeScratch.sizeInBytes() + layerJobBytes.load(std::memory_order_relaxed);
+
+    // The device allocator also holds every model's weights and noise;
+    // the rest of what it has handed out is the forwards' working set
+    const size_t allocated = usage.allocatorAllocated;
+    activations += allocated > modelBytes ? allocated - modelBytes : 0;
+
+    memory.set(Component::Weights, weights);
+    memory.set(Component::Activations, activations);
+    memory.set(Component::AllocatorPool, usage.allocatorReserved > allocated ? usage.allocatorReserved - allocated : 0);
+    memory.set(Component::FrameBuffers, frames);
+    memory.set(Component::Caches, caches);
+
+    constexpr double megabyte = 1024.0 * 1024.0;
+    std::cout << "Autolume: Memory " << memory.total() / megabyte << " MB (";
+    for (size_t i = 0; i < MemoryAccounting::numComponents; i++) {
+        const auto component = static_cast<Component>(i);
+        std::cout << (i > 0 ? ", " : "") << MemoryAccounting::name(component) << " "
+                  << memory.get(component) / megabyte;
+    }
+    std::cout << ")" << std::endl;
+}
+
 bool Autolume::loadModel(const std::string& path) {
     std::cout << "Autolume: Loading model from: " << path << std::endl;
 
-    try {
-        // Load model
-        model = torch::jit::load(path);
-        model.eval();
-        modelPath = path;
+    // configure() may run on another thread meanwhile
+    const PipelineConfig modelConfig = getConfig();
+    if (modelConfig.analysisOnly) {
+        std::cerr << "Autolume: Analysis-only instances don't load models" << std::endl;
+        return false;
+    }
+
+    // The inference thread owns the engine while it runs; stop it so the
+    // new model gets a fresh device setup and workers
+    stopInferenceThread();
+
+    if (!loadEngine() || !engine->loadModel(path, modelConfig)) {
+        return false;
+    }
+    modelPath = path;
+
+    // A basis next to the checkpoint marks a latent-input model
+    std::vector<float> basis;
+    int latentDim = 0;
+    int numFeatures = 0;
+    latentProjection.clear();
+    latentProjection.setCacheBudget(modelConfig.memoryBudgets.latentCache);
+    if (engine->getProjectionBasis(basis, latentDim, numFeatures)) {
+        latentProjection.setBasis(basis.data(), latentDim, numFeatures);
+        latentBuf.allocate(latentDim);
+    }
+    accountFeatureState();
+
+    std::cout << "Autolume: Model loaded successfully" << std::endl;
+
+    // Mark model as loaded
+    modelLoaded.store(true, std::memory_order_release);
+
+    // Start inference thread if not already running
+    if (!inferenceThread.joinable()) {
+        shouldExit.store(false, std::memory_order_release);
+        inferenceThread = std::thread(&Autolume::inferenceThreadLoop, this);
+        std::cout << "Autolume: Inference thread started" << std::endl;
+    }
+
+    return true;
+}
+
+bool Autolume::addLayer(const std::string& path, const LayerSettings& settings) {
+    std::cout << "Autolume: Loading layer from: " << path << std::endl;
+
+    PipelineConfig layerConfig = getConfig();
+    if (layerConfig.analysisOnly) {
+        std::cerr << "Autolume: Analysis-only instances don't load models" << std::endl;
+        return false;
+    }
+    if (!loadEngine()) {
+        return false;
+    }
 
-        // Prepare input tensor
-        std::cout << "Autolume: Creating input tensor..." << std::endl;
-        inputTensor = torch::empty({1, Constants::nfft}, torch::kFloat32);
-        inputs.reserve(1);
-        inputs.clear();
-        inputs.emplace_back(inputTensor);
+    // Layer forwards run on the frame workers, one slot each if the device allows
+    layerConfig.inferenceWorkers = std::max(1, live.inferenceWorkers.load(std::memory_order_relaxed));
+
+    auto layer = std::make_shared<ModelLayer>();
+    layer->engine = createEngine();
+    layer->destroy = destroyEngine;
+    layer->path = path;
+    layer->settings = settings;
+    if (!layer->engine->loadModel(path, layerConfig)) {
+        return false;
+    }
 
-        // Find and cache noise_strength parameters
-        findNoiseStrengthParameters();
+    // Device setup happens on the inference thread (updateLayers), where
+    // the primary's device and workers are known
+    const int nfft = live.nfft.load(std::memory_order_relaxed);
+    std::vector<float> basis;
+    int latentDim = 0;
+    int numFeatures = 0;
+    layer->inputSize = static_cast<size_t>(nfft);
+    if (layer->engine->getProjectionBasis(basis, latentDim, numFeatures)) {
+        layer->projection.setCacheBudget(layerConfig.memoryBudgets.latentCache);
+        layer->projection.setBasis(basis.data(), latentDim, numFeatures);
+        layer->inputSize = static_cast<size_t>(latentDim);
+    }
+    layer->input.allocate(nfft);
+
+    std::lock_guard<std::mutex> lock(layerMutex);
+    pendingLayers.push_back(std::move(layer));
+    return true;
+}
+
+void Autolume::setUpLayer(ModelLayer& layer) {
+    // Layer forwards run on the primary's frame workers, one slot each if
+    // the device allows; the primary engine owns the thread split
+    const int numWorkers = static_cast<int>(std::max<size_t>(1, workers.size()));
+    if (!layer.engine->initializeDevice(layer.width, layer.height)) {
+        std::cerr << "Autolume: Layer " << layer.path << " couldn't set up a device" << std::endl;
+        layer.failed = true;
+        return;
+    }
+    layer.numSlots = std::max(1, layer.engine->prepareSlots(numWorkers));
+    layer.slotMutexes = std::make_unique<std::mutex[]>(static_cast<size_t>(layer.numSlots));
+    layer.frameSize = static_cast<size_t>(layer.width) * layer.height * Constants::frameNumCh;
+    layer.frame.allocate(layer.frameSize);
+    layer.ready = true;
+}
 
-        std::cout << "Autolume: Model loaded successfully" << std::endl;
+bool Autolume::setLayerSettings(int index, const LayerSettings& settings) {
+    std::lock_guard<std::mutex> lock(layerMutex);
+    if (index < 0 || index >= static_cast<int>(layers.size() + pendingLayers.size())) {
+        return false;
+    }
 
-        // Mark model as loaded
-        modelLoaded.store(true, std::memory_order_release);
+    const auto numActive = static_cast<int>(layers.size());
+    auto& layer = index < numActive ? *layers[index] : *pendingLayers[index - numActive];
+    layer.settings = settings;
+    return true;
+}
 
-        // Start inference thread if not already running
+void Autolume::clearLayers() {
+    std::vector<std::shared_ptr<ModelLayer>> removed;
+    {
+        std::lock_guard<std::mutex> lock(layerMutex);
+        removed.swap(pendingLayers);
         if (!inferenceThread.joinable()) {
-            shouldExit.store(false, std::memory_order_release);
-            inferenceThread = std::thread(&Autolume::inferenceThreadLoop, this);
-            std::cout << "Autolume: Inference thread started" << std::endl;
+            layers.clear();
+            return;
         }
+    }
+
+    // Layers in use are released by the inference thread between frames
+    clearLayersRequested.store(true, std::memory_order_release);
+}
 
+int Autolume::getNumLayers() {
+    std::lock_guard<std::mutex> lock(layerMutex);
+    return static_cast<int>(layers.size() + pendingLayers.size());
+}
+
+void Autolume::stopInferenceThread() {
+    if (!inferenceThread.joinable()) {
+        return;
+    }
+
+    shouldExit.store(true, std::memory_order_release);
+    inferenceThread.join();
+    shouldExit.store(false, std::memory_order_release);
+    modelLoaded.store(false, std::memory_order_release);
+    mpsInitialized.store(false, std::memory_order_release);
+    nextDispatchSeq = 0;
+    nextPublishSeq = 0;
+    work.framesInFlight.store(0, std::memory_order_release);
+}
+
+bool Autolume::loadEngine() {
+    if (engine) {
         return true;
     }
-    catch (const std::exception& e) {
-        std::cerr << "Autolume: ERROR loading model: " << e.what() << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Look next to this binary first, then on the loader's search path
+    std::string libraryPath = EngineLibrary::fileName;
+    Dl_info info;
+    if (dladdr(static_cast<const void*>(&EngineLibrary::fileName), &info) && info.dli_fname) {
+        std::string self = info.dli_fname;
+        libraryPath = self.substr(0, self.find_last_of('/') + 1) + EngineLibrary::fileName;
+    }
+
+    void* library = dlopen(libraryPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!library) {
+        library = dlopen(EngineLibrary::fileName, RTLD_NOW | RTLD_LOCAL);
+    }
+    if (!library) {
+        std::cerr << "Autolume: ERROR loading inference engine: " << dlerror() << std::endl;
         return false;
     }
-}
 
+    createEngine = reinterpret_cast<CreateInferenceEngineFn>(dlsym(library, EngineLibrary::createSymbol));
+    destroyEngine = reinterpret_cast<DestroyInferenceEngineFn>(dlsym(library, EngineLibrary::destroySymbol));
+    if (!createEngine || !destroyEngine) {
+        std::cerr << "Autolume: ERROR inference engine is missing its entry points" << std::endl;
+        return false;
+    }
+
+    // The library is never closed: libtorch keeps thread pools and static
+    // state alive until the process exits
+    engine = createEngine();
+
+    float millis = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Autolume: Inference engine loaded in " << millis << " ms" << std::endl;
+    return true;
+}
 Autolume::~Autolume() {
     // Signal thread to exit
     shouldExit.store(true, std::memory_order_release);
@@ -84,305 +557,1072 @@ Autolume::~Autolume() {
         inferenceThread.join();
     }
 
+    // Layer engines come from the same library as the primary one
+    layers.clear();
+    pendingLayers.clear();
+
+    if (engine) {
+        destroyEngine(engine);
+    }
+
+    // Let another instance publish under this name
+    if (busPublication) {
+        busPublication->release();
+    }
+
     // Clean up FFT setup
     if (fftSetup) {
         vDSP_destroy_fftsetup(fftSetup);
     }
 }
 
-void Autolume::processAudio(float val) {
+template <typename SampleType>
+void Autolume::processAudio(SampleType val) {
     // Audio thread: accumulate samples into circular buffer
-    in_buf[rp] = val;
-    rp = (rp + 1) & (Constants::max_buf_size - 1);
-    cnt++;
+    in_buf[audio.rp] = static_cast<AnalysisSample>(val);
+    audio.rp = (audio.rp + 1) & (Constants::max_buf_size - 1);
+    audio.cnt++;
+
+    if (audio.bandEnvelopes) {
+        bandEnvelopes.process(static_cast<float>(val));
+    }
 
-    // Every nfft samples, copy to ordered_in_buf and signal inference thread
-    if (cnt >= Constants::nfft) {
-        cnt = 0;
+    if (audio.slidingDft) {
+        // The sample leaving the window is still in the ring
+        int delayed = (audio.rp - 1 - slidingDft.getWindowSize() + Constants::max_buf_size) & (Constants::max_buf_size - 1);
+        slidingDft.process(static_cast<double>(val), static_cast<double>(in_buf[delayed]));
+    }
+
+    // Every hop, publish an ordered snapshot of the history to the hop ring
+    if (audio.cnt >= audio.hopSize) {
+        audio.cnt = 0;
+
+        // Warm-up blocks still copy (that is what they warm) but into the
+        // scratch slot, and never publish
+        uint64_t w = hopWriteIndex.load(std::memory_order_relaxed);
+        const uint64_t slotIndex = audio.warmUp ? Constants::numHopSlots : w % Constants::numHopSlots;
+        AnalysisSample* slot = hopSlots.data() + slotIndex * Constants::max_nfft;
 
         // Copy samples in order
-        for (size_t i = 0; i < Constants::nfft; i++) {
-            ordered_in_buf[i] = in_buf[(rp + i - Constants::nfft + Constants::max_buf_size) & (Constants::max_buf_size - 1)];
+        const int n = audio.historySize;
+        for (int i = 0; i < n; i++) {
+            slot[i] = in_buf[(audio.rp + i - n + Constants::max_buf_size) & (Constants::max_buf_size - 1)];
         }
 
-        // Signal that new input is ready (lock-free atomic flag)
-        inputReady.store(true, std::memory_order_release);
+        if (audio.warmUp) {
+            return;
+        }
+
+        // Publish (lock-free, the audio thread never waits on the consumer)
+        hopTimes[w % Constants::numHopSlots].store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                                                  std::memory_order_relaxed);
+        hopWriteIndex.store(w + 1, std::memory_order_release);
     }
 }
 
-void Autolume::inferenceThreadLoop() {
-    using namespace std::chrono;
+template void Autolume::processAudio<float>(float);
+template void Autolume::processAudio<double>(double);
 
-    // Initialize best available device on this dedicated thread
-    try {
-        std::cout << "Autolume: Detecting available devices..." << std::endl;
-
-        // Try devices in order of preference: CUDA -> MPS -> CPU
-        bool deviceInitialized = false;
-        std::string deviceName;
-
-        // Try CUDA first
-        if (torch::cuda::is_available()) {
-            try {
-                std::cout << "Autolume: CUDA detected, initializing..." << std::endl;
-                device = torch::Device(torch::kCUDA);
-                deviceName = "CUDA";
-                deviceInitialized = true;
-            } catch (const std::exception& e) {
-                std::cerr << "Autolume: CUDA initialization failed: " << e.what() << std::endl;
-            }
-        }
+void Autolume::beginAudioWarmUp() {
+    audio.warmUp = true;
+}
 
-        // Try MPS if CUDA failed or unavailable
-        if (!deviceInitialized && torch::mps::is_available()) {
-            try {
-                std::cout << "Autolume: MPS detected, initializing..." << std::endl;
-                device = torch::Device(torch::kMPS);
-                deviceName = "MPS";
-                deviceInitialized = true;
-            } catch (const std::exception& e) {
-                std::cerr << "Autolume: MPS initialization failed: " << e.what() << std::endl;
-            }
-        }
+void Autolume::endAudioWarmUp() {
+    audio.warmUp = false;
+    audio.rp = 0;
+    audio.cnt = 0;
+    in_buf.fill(0);
+    bandEnvelopes.reset();
+    slidingDft.reset();
+}
 
-        // Fall back to CPU
-        if (!deviceInitialized) {
-            std::cout << "Autolume: Falling back to CPU..." << std::endl;
-            device = torch::Device(torch::kCPU);
-            deviceName = "CPU";
-            deviceInitialized = true;
-        }
+void Autolume::visitAudioMemory(const AudioMemory::Visitor& visit) const {
+    visit(&audio, sizeof(audio));
+    visit(in_buf.data(), sizeof(in_buf));
+    visit(&bandEnvelopes, sizeof(bandEnvelopes));
+    visit(&slidingDft, sizeof(slidingDft));
+    visit(hopSlots.data(), hopSlots.sizeInBytes());
+    visit(&hopWriteIndex, sizeof(hopWriteIndex));
+    visit(&audioPageFaults, sizeof(audioPageFaults));
+    visit(hopTimes.data(), sizeof(hopTimes));
+}
 
-        std::cout << "Autolume: Using device: " << deviceName << std::endl;
+int Autolume::readQueuedHops(float* dest, uint64_t& hopIndex) {
+    // Inference thread: copy every unread hop still in the ring, oldest first
+    uint64_t w = hopWriteIndex.load(std::memory_order_acquire);
+    uint64_t r = hopReadIndex.load(std::memory_order_relaxed);
+    if (w == r) {
+        return 0;
+    }
 
-        std::cout << "Autolume: Moving model to " << deviceName << "..." << std::endl;
-        model.to(device);
+    // The slot of hop w is being written; anything older than
+    // w - (numHopSlots - 1) has already been overwritten
+    uint64_t first = std::max(r, w - std::min<uint64_t>(w, Constants::numHopSlots - 1));
+    int count = static_cast<int>(w - first);
+    for (int i = 0; i < count; i++) {
+        const AnalysisSample* slot = hopSlots.data() + ((first + i) % Constants::numHopSlots) * Constants::max_nfft;
+        std::copy(slot, slot + analysisHistorySize, dest + static_cast<size_t>(i) * Constants::max_nfft);
+    }
 
-        std::cout << "Autolume: Moving tensor to " << deviceName << "..." << std::endl;
-        inputTensor = inputTensor.to(device, false, false);
-        inputs.clear();
-        inputs.emplace_back(inputTensor);
+    // The producer reuses a slot once it starts hop idx + numHopSlots; drop
+    // the oldest copies if it got that far while we were copying
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t after = hopWriteIndex.load(std::memory_order_relaxed);
+    int skip = 0;
+    while (skip < count && after - (first + skip) >= Constants::numHopSlots) {
+        skip++;
+    }
+    if (skip == count) {
+        return 0;
+    }
+    if (skip > 0) {
+        std::copy(dest + static_cast<size_t>(skip) * Constants::max_nfft,
+                  dest + static_cast<size_t>(count) * Constants::max_nfft, dest);
+    }
 
-        mpsInitialized.store(true, std::memory_order_release);
-        std::cout << "Autolume: Device initialization complete on " << deviceName << "!" << std::endl;
+    infer.droppedHops.store(infer.droppedHops.load(std::memory_order_relaxed) + (first - r) + skip,
+                            std::memory_order_relaxed);
+    hopReadIndex.store(w, std::memory_order_release);
+    hopIndex = w - 1;
+    return count - skip;
+}
 
-        // Test forward pass immediately after initialization
-        try {
-            std::cout << "Autolume: Testing forward pass..." << std::endl;
-            torch::NoGradGuard no_grad;
-            auto test_output = model.forward(inputs).toTensor();
-            std::cout << "Autolume: Test forward pass succeeded! Output shape: ["
-                      << test_output.size(0) << ", " << test_output.size(1) << ", "
-                      << test_output.size(2) << ", " << test_output.size(3) << "]" << std::endl;
-        }
-        catch (const std::exception& e) {
-            std::cerr << "Autolume: Test forward pass FAILED: " << e.what() << std::endl;
-        }
-    }
-    catch (const std::exception& e) {
-        std::cerr << "Autolume: Device initialization failed: " << e.what() << std::endl;
+void Autolume::inferenceThreadLoop() {
+    using namespace std::chrono;
+
+    // Initialize best available device on this dedicated thread
+    int width = 0;
+    int height = 0;
+    bool deviceReady = engine->initializeDevice(width, height);
+    mpsInitialized.store(true, std::memory_order_release);
+    if (!deviceReady) {
         std::cerr << "Autolume: Unable to initialize any device (CUDA/MPS/CPU). Exiting inference thread." << std::endl;
-        mpsInitialized.store(true, std::memory_order_release);
         // Exit thread if initialization failed
         return;
     }
 
+    if (width != getFrameWidth() || height != getFrameHeight()
+        || static_cast<int>(frameBuffers.size()) != getNumFrameBuffers()) {
+        allocateFrameBuffers(width, height);
+    }
+    std::cout << "Autolume: Frame size " << width << "x" << height
+              << (FrameKernels::findFixedKernel(width, height) ? " (fixed-size kernel)" : " (generic kernel)")
+              << std::endl;
+
+    startWorkers(live.inferenceWorkers.load(std::memory_order_relaxed));
+    taskPool.start(live.taskThreads.load(std::memory_order_relaxed));
+    std::cout << "Autolume: " << taskPool.getNumThreads() << " task threads" << std::endl;
+    updateLayers();
+    reportMemory();
+
     // Main inference loop (like autolumelive's _process_fn)
     std::cout << "Autolume: Entering inference loop..." << std::endl;
+    auto lastCostReport = steady_clock::now();
     while (!shouldExit.load(std::memory_order_acquire)) {
+        updateLayers();
+
+        // A new lookahead needs another queue length; resize between frames
+        if (static_cast<int>(frameBuffers.size()) != getNumFrameBuffers()
+            && work.framesInFlight.load(std::memory_order_acquire) == 0) {
+            allocateFrameBuffers(getFrameWidth(), getFrameHeight());
+        }
+
         // Check if inference is requested
-        if (inferenceRequested.load(std::memory_order_acquire)) {
+        uint32_t requested = gui.inferenceRequestSeq.load(std::memory_order_acquire);
+        if (requested != infer.inferenceServedSeq.load(std::memory_order_relaxed)) {
             runInference();
-            inferenceRequested.store(false, std::memory_order_release);
+            infer.inferenceServedSeq.store(requested, std::memory_order_release);
+        }
+
+        // Report the feature stage cost every few seconds
+        if (steady_clock::now() - lastCostReport > seconds(10)) {
+            lastCostReport = steady_clock::now();
+            std::cout << "Autolume: Feature stage " << getAnalysisCostMicros() << " us/hop" << std::endl;
+            if (live.verifyAudioFaults.load(std::memory_order_relaxed)) {
+                std::cout << "Autolume: Audio thread page faults " << getAudioPageFaults() << std::endl;
+            }
+            reportMemory();
         }
 
         // Sleep briefly to avoid busy-waiting
         std::this_thread::sleep_for(milliseconds(1));
     }
 
+    // Workers publish through the pool, so it stops after them
+    stopWorkers();
+    taskPool.stop();
     std::cout << "Autolume: Inference thread exiting..." << std::endl;
 }
 
+void Autolume::analysisThreadLoop() {
+    using namespace std::chrono;
+
+    // Same cadence the editor requests frames at, so subscribers see one
+    // fresh snapshot per rendered frame
+    auto next = steady_clock::now();
+    while (!shouldExit.load(std::memory_order_acquire)) {
+        extractFeatures();
+        next += duration_cast<steady_clock::duration>(duration<double>(1.0 / live.fps.load(std::memory_order_relaxed)));
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void Autolume::startWorkers(int numWorkers) {
+    // The engine decides how many concurrent slots its device supports,
+    // and the primary engine alone claims their threads
+    numWorkers = engine->prepareSlots(numWorkers);
+    engine->shareThreads(std::max(1, numWorkers));
+    if (numWorkers <= 1) {
+        inlineJob.input.allocate(std::max<size_t>(inference_input_buf.size(), latentBuf.size()));
+        infer.maxFramesInFlight.store(1, std::memory_order_release);
+        return;
+    }
+
+    for (int i = 0; i < numWorkers; i++) {
+        auto worker = std::make_unique<InferenceWorker>();
+        worker->slot = i;
+        worker->job.input.allocate(std::max<size_t>(inference_input_buf.size(), latentBuf.size()));
+        workers.push_back(std::move(worker));
+    }
+    for (auto& worker : workers) {
+        worker->worker = std::thread(&Autolume::workerLoop, this, std::ref(*worker));
+    }
+
+    infer.maxFramesInFlight.store(numWorkers, std::memory_order_release);
+    accountFeatureState();
+    std::cout << "Autolume: " << numWorkers << " frame workers" << std::endl;
+}
+void Autolume::stopWorkers() {
+    // Workers poll shouldExit while waiting, so joining is enough
+    for (auto& worker : workers) {
+        if (worker->worker.joinable()) {
+            worker->worker.join();
+        }
+    }
+    workers.clear();
+    inlineJob.layerJobs.clear();
+    inlineJob.numLayerJobs = 0;
+    layerJobBytes.store(0, std::memory_order_relaxed);
+    accountFeatureState();
+
+    // Other engines' workers get the cores back
+    engine->shareThreads(0);
+}
+
+void Autolume::workerLoop(InferenceWorker& worker) {
+    using namespace std::chrono;
+
+    while (!shouldExit.load(std::memory_order_acquire)) {
+        {
+            std::unique_lock<std::mutex> lock(worker.jobMutex);
+            if (!worker.jobChanged.wait_for(lock, milliseconds(10), [&] { return worker.hasJob; })) {
+                continue;
+            }
+        }
+
+        // The dispatcher doesn't touch the job until hasJob is cleared
+        renderFrame(worker.job, worker.slot);
+
+        {
+            std::lock_guard<std::mutex> lock(worker.jobMutex);
+            worker.hasJob = false;
+        }
+        worker.jobChanged.notify_all();
+    }
+}
+
 void Autolume::requestInference() {
     // Don't request if not initialized yet
     if (!isInitialized.load(std::memory_order_acquire)) {
         return;
     }
 
-    // Skip if inference is already running (avoid overlapping calls)
-    if (inferenceRunning.load(std::memory_order_acquire)) {
+    // Skip while every worker has a frame in flight (avoid queueing stale requests)
+    if (work.framesInFlight.load(std::memory_order_acquire) >= infer.maxFramesInFlight.load(std::memory_order_relaxed)) {
         return;
     }
 
-    // Signal inference thread to run inference (no MessageManager needed)
-    inferenceRequested.store(true, std::memory_order_release);
+    // Signal inference thread to run inference (no MessageManager needed).
+    // Only the GUI thread writes this counter, so a plain load/store is enough.
+    uint32_t seq = gui.inferenceRequestSeq.load(std::memory_order_relaxed);
+    gui.inferenceRequestSeq.store(seq + 1, std::memory_order_release);
 }
 
 void Autolume::runInference() {
+    using namespace std::chrono;
+
     // Don't run inference if not initialized yet
     if (!isInitialized.load(std::memory_order_acquire)) {
         return;
     }
 
-    // Mark inference as running
-    inferenceRunning.store(true, std::memory_order_release);
+    // Mark a frame in flight until it is published
+    work.framesInFlight.fetch_add(1, std::memory_order_acq_rel);
+    const uint64_t seq = nextDispatchSeq++;
 
+    // Inputs are prepared here in request order, so the latent walk and the
+    // feature history stay sequential whichever worker renders the frame
+    float seedX = 0.0f;
+    float seedY = 0.0f;
+    float* input = nullptr;
     try {
-        // Copy input if available (lock-free read from audio thread)
-        std::array<float, Constants::nfft> audio_samples;
-        if (inputReady.load(std::memory_order_acquire)) {
-            std::copy(ordered_in_buf.begin(), ordered_in_buf.end(), audio_samples.begin());
-            inputReady.store(false, std::memory_order_release);
-        } else {
-            // Use previous samples if no new data
-            audio_samples.fill(0.0f);
+        input = prepareModelInput(seedX, seedY);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Autolume: Feature extraction error: " << e.what() << std::endl;
+        publishFrame(seq, nullptr, {});
+        return;
+    }
+
+    // The frame belongs to the newest audio it analysed, which the host
+    // plays once the lookahead has passed
+    const auto due = analysedHopTime + duration_cast<steady_clock::duration>(duration<double, std::milli>(live.lookaheadMs.load(std::memory_order_relaxed)));
+
+    // Without workers the frame renders here; otherwise round-robin:
+    // frame seq goes to worker seq % K once it is idle
+    InferenceWorker* worker = workers.empty() ? nullptr : workers[seq % workers.size()].get();
+    std::unique_lock<std::mutex> lock;
+    if (worker) {
+        lock = std::unique_lock<std::mutex>(worker->jobMutex);
+        while (worker->hasJob) {
+            if (shouldExit.load(std::memory_order_acquire)) {
+                // Frame seq is dropped without publishing: framesInFlight
+                // and nextPublishSeq stay where they are, and the stop path
+                // relies on stopInferenceThread() resetting both (and
+                // nextDispatchSeq) after the join
+                return;
+            }
+            worker->jobChanged.wait_for(lock, milliseconds(10));
         }
+    }
 
-        // Compute FFT magnitude using Apple Accelerate vDSP
-        // Step 1: Convert real input to split complex format
-        // vDSP expects input as interleaved complex, reinterpret as DSPComplex
-        vDSP_ctoz(reinterpret_cast<DSPComplex*>(audio_samples.data()), 2, &fftSplit, 1, Constants::nfft / 2);
+    // The job carries the frame's layer inputs too, so the layers render
+    // alongside the primary frame they are blended into
+    auto& job = worker ? worker->job : inlineJob;
+    const size_t inputSize = latentProjection.isActive() ? latentBuf.size() : static_cast<size_t>(live.nfft.load(std::memory_order_relaxed));
+    std::copy(input, input + inputSize, job.input.begin());
+    job.seq = seq;
+    job.seedX = seedX;
+    job.seedY = seedY;
+    job.due = due;
+    scheduleLayers(job);
+
+    if (!worker) {
+        renderFrame(job, 0);
+        return;
+    }
+    worker->hasJob = true;
+    lock.unlock();
+    worker->jobChanged.notify_all();
+}
 
-        // Step 2: Perform forward FFT (real-to-complex)
-        vDSP_fft_zrip(fftSetup, &fftSplit, 1, fftLog2n, FFT_FORWARD);
+float* Autolume::prepareModelInput(float& seedX, float& seedY) {
+    // Fill inference_input_buf from the latest audio
+    extractFeatures();
 
-        vDSP_zvabs(&fftSplit, 1, inference_input_buf.data(), 1, Constants::nfft / 2);
+    // Update latent coordinates based on time delta and speed (animation always on)
+    auto now = std::chrono::steady_clock::now();
+    float delta = std::chrono::duration<float>(now - lastLatentUpdate).count();
+    lastLatentUpdate = now;
 
-        // Step 5: Fill second half with zeros (or mirror if you want full spectrum)
-        std::fill(inference_input_buf.begin() + Constants::nfft / 2, inference_input_buf.end(), 0.0f);
+    float speed = gui.latentSpeed.load(std::memory_order_acquire);
+    float x = infer.latentX.load(std::memory_order_relaxed);
+    x += std::abs(delta) * speed;
+    infer.latentX.store(x, std::memory_order_release);
 
-        // Copy CPU buffer to MPS tensor (can't use accessor on MPS tensor)
-        // Create CPU tensor from buffer, then copy to MPS
-        auto cpu_tensor = torch::from_blob(
-            inference_input_buf.data(),
-            {1, Constants::nfft},
-            torch::kFloat32
-        ).clone();  // Clone to own the data
+    // Get current seed coordinates
+    seedX = x;
+    seedY = infer.latentY.load(std::memory_order_relaxed);
 
-        // Copy to preallocated MPS tensor
-        inputTensor.copy_(cpu_tensor);
+    if (latentProjection.isActive()) {
+        // Latent-input model: latent = base(seed) + B * features
+        latentProjection.project(seedX, seedY, inference_input_buf.data(), latentBuf.data());
+        return latentBuf.data();
+    }
+    return inference_input_buf.data();
+}
+
+const float* Autolume::renderPrimary(int slot, uint64_t seq, const float* input, float seedX, float seedY) {
+    using namespace std::chrono;
 
-        // Update latent coordinates based on time delta and speed (animation always on)
-        auto now = std::chrono::steady_clock::now();
-        float delta = std::chrono::duration<float>(now - lastLatentUpdate).count();
-        lastLatentUpdate = now;
+    auto start = steady_clock::now();
+    const float* output = engine->render(slot, seq, input, seedX, seedY);
+    float micros = duration<float, std::micro>(steady_clock::now() - start).count();
 
-        float speed = latentSpeed.load(std::memory_order_acquire);
-        float x = latentX.load(std::memory_order_acquire);
-        x += std::abs(delta) * speed;
-        latentX.store(x, std::memory_order_release);
+    // Workers may race on the update; an occasional lost sample is harmless
+    float average = work.primaryCostMicros.load(std::memory_order_relaxed);
+    work.primaryCostMicros.store(average == 0.0f ? micros : average + 0.05f * (micros - average),
+                                 std::memory_order_relaxed);
+    return output;
+}
 
-        // Get current seed coordinates
-        float seed_x = latentX.load(std::memory_order_acquire);
-        float seed_y = latentY.load(std::memory_order_acquire);
+void Autolume::updateLayers() {
+    if (clearLayersRequested.exchange(false, std::memory_order_acq_rel)) {
+        std::vector<std::shared_ptr<ModelLayer>> removed;
+        {
+            std::lock_guard<std::mutex> lock(layerMutex);
+            removed.swap(layers);
+        }
+        layerScheduler.reset(0);
+    }
+
+    // New layers get their device here, outside layerMutex so the GUI can
+    // keep adding and clearing; the frame loop pauses while one is set up
+    std::vector<std::shared_ptr<ModelLayer>> arriving;
+    {
+        std::lock_guard<std::mutex> lock(layerMutex);
+        for (const auto& layer : pendingLayers) {
+            if (!layer->ready && !layer->failed) {
+                arriving.push_back(layer);
+            }
+        }
+    }
+    for (auto& layer : arriving) {
+        setUpLayer(*layer);
+    }
+
+    // A reloaded primary model may render at another size, so adopting a
+    // set-up layer is a size check; cleared layers are no longer pending
+    const size_t frameSize = getFrameBytes();
+    std::lock_guard<std::mutex> lock(layerMutex);
+    auto mismatched = [&](const auto& layer) { return layer->frameSize != frameSize; };
+    if (std::any_of(layers.begin(), layers.end(), mismatched)) {
+        std::cerr << "Autolume: Dropping layers that don't match the " << getFrameWidth() << "x"
+                  << getFrameHeight() << " frame" << std::endl;
+        layers.erase(std::remove_if(layers.begin(), layers.end(), mismatched), layers.end());
+        layerScheduler.reset(static_cast<int>(layers.size()));
+    }
+
+    std::vector<std::shared_ptr<ModelLayer>> waiting;
+    for (auto& layer : pendingLayers) {
+        if (!layer->ready && !layer->failed) {
+            // Added after the setup pass above
+            waiting.push_back(std::move(layer));
+            continue;
+        }
+        if (layer->failed) {
+            continue;
+        }
+        if (mismatched(layer)) {
+            std::cerr << "Autolume: Layer " << layer->path << " renders " << layer->width << "x" << layer->height
+                      << ", not the primary " << getFrameWidth() << "x" << getFrameHeight() << std::endl;
+            continue;
+        }
+        if (compositeBuf.size() != frameSize) {
+            compositeBuf.allocate(frameSize);
+            compositeScratch.allocate(frameSize);
+        }
+        layer->lastUpdate = std::chrono::steady_clock::now();
+        layers.push_back(std::move(layer));
+        layerScheduler.addLayer();
+        std::cout << "Autolume: Layer " << layers.size() << " ready: " << layers.back()->path << std::endl;
+    }
+    pendingLayers.swap(waiting);
+}
 
-        // Run model inference with seed coordinates (pass as tensors)
-        torch::NoGradGuard no_grad;
-        std::vector<torch::jit::IValue> model_inputs;
-        model_inputs.push_back(inputTensor);
-        model_inputs.push_back(torch::tensor(seed_x, device));
-        model_inputs.push_back(torch::tensor(seed_y, device));
-        model_inputs.push_back(torch::tensor(true, device));  // Always use seed-based generation
+void Autolume::scheduleLayers(FrameJob& job) {
+    using namespace std::chrono;
 
-        auto output = model.forward(model_inputs).toTensor();
+    job.numLayerJobs = 0;
+    if (layers.empty()) {
+        return;
+    }
 
-        // Convert output tensor to RGB image
-        // Assuming output is [1, 3, 512, 512] in range [-1, 1] or [0, 1]
-        output = output.squeeze(0);  // [3, 512, 512]
-        output = output.permute({1, 2, 0});  // [512, 512, 3]
-        output = output.to(torch::kCPU);
+    {
+        std::lock_guard<std::mutex> lock(layerMutex);
+        for (size_t i = 0; i < layers.size(); i++) {
+            layers[i]->active = layers[i]->settings;
+            layerScheduler.setSettings(static_cast<int>(i), layers[i]->active);
+        }
+    }
 
-        // Clamp and convert to uint8
-        output = (output + 1.0f) * 127.5f;  // Convert from [-1, 1] to [0, 255]
-        output = output.clamp(0.0f, 255.0f);
+    // Fold in the forward times the workers measured since the last frame
+    for (size_t i = 0; i < layers.size(); i++) {
+        auto& layer = *layers[i];
+        const uint32_t samples = layer.costSamples.load(std::memory_order_acquire);
+        if (samples != layer.seenCostSamples) {
+            layer.seenCostSamples = samples;
+            layerScheduler.recordCost(static_cast<int>(i), layer.lastCostMicros.load(std::memory_order_relaxed));
+        }
+    }
 
-        auto data = output.contiguous();
-        auto* ptr = data.data_ptr<float>();
+    // Layers share what the primary model leaves of the frame period; its
+    // workers run in parallel, so each costs a fraction of a forward
+    const float period = 1.0e6f / static_cast<float>(live.fps.load(std::memory_order_relaxed));
+    const float primary = work.primaryCostMicros.load(std::memory_order_relaxed)
+                        / static_cast<float>(std::max<size_t>(1, workers.size()));
 
-        // Write to the write buffer
-        auto& writeBuffer = frameBuffer[writeFrameIndex];
-        for (size_t i = 0; i < Constants::frameBytes; i++) {
-            writeBuffer[i] = static_cast<uint8_t>(ptr[i]);
+    const auto now = steady_clock::now();
+    const auto& scheduled = layerScheduler.schedule(std::max(0.0f, period - primary));
+    if (job.layerJobs.size() < scheduled.size()) {
+        job.layerJobs.resize(scheduled.size());
+    }
+    for (int i : scheduled) {
+        const auto& layerPtr = layers[i];
+        auto& layer = *layerPtr;
+        const auto& settings = layer.active;
+
+        // Routed slice of the features, zero-padded to the model input size
+        const int nfft = live.nfft.load(std::memory_order_relaxed);
+        const int offset = std::clamp(settings.featureOffset, 0, nfft);
+        const int available = nfft - offset;
+        const int count = settings.featureCount > 0 ? std::min(settings.featureCount, available) : available;
+        std::fill(layer.input.begin(), layer.input.end(), 0.0f);
+        std::copy(inference_input_buf.data() + offset, inference_input_buf.data() + offset + count, layer.input.begin());
+
+        // The walk advances by wall time, so skipped frames don't slow it down
+        layer.seedX += std::abs(duration<float>(now - layer.lastUpdate).count()) * settings.latentSpeed;
+        layer.lastUpdate = now;
+
+        auto& layerJob = job.layerJobs[job.numLayerJobs++];
+        if (layerJob.input.size() < layer.inputSize) {
+            layerJobBytes.fetch_sub(layerJob.input.sizeInBytes(), std::memory_order_relaxed);
+            layerJob.input.allocate(layer.inputSize);
+            layerJobBytes.fetch_add(layerJob.input.sizeInBytes(), std::memory_order_relaxed);
         }
+        if (layerJob.output.size() != layer.frameSize) {
+            layerJobBytes.fetch_sub(layerJob.output.sizeInBytes(), std::memory_order_relaxed);
+            layerJob.output.allocate(layer.frameSize);
+            layerJobBytes.fetch_add(layerJob.output.sizeInBytes(), std::memory_order_relaxed);
+        }
+        if (layer.projection.isActive()) {
+            layer.projection.project(layer.seedX, settings.seedY, layer.input.data(), layerJob.input.data());
+        } else {
+            std::copy(layer.input.begin(), layer.input.end(), layerJob.input.begin());
+        }
+        layerJob.layer = layerPtr;
+        layerJob.seq = layer.seq++;
+        layerJob.seedX = layer.seedX;
+        layerJob.seedY = settings.seedY;
+        layerJob.rendered = false;
+    }
+}
+
+void Autolume::renderFrame(FrameJob& job, int slot) {
+    using namespace std::chrono;
 
-        // Swap buffers atomically
+    for (int j = 0; j < job.numLayerJobs; j++) {
+        auto& layerJob = job.layerJobs[j];
+        auto& layer = *layerJob.layer;
+
+        // Workers beyond the layer's slots share them; the output belongs
+        // to the slot, so it is copied before the slot is released
+        const int layerSlot = slot % layer.numSlots;
+        auto start = steady_clock::now();
         {
-            std::lock_guard<std::mutex> lock(frameMutex);
-            int oldReadable = readableFrameIndex.load(std::memory_order_relaxed);
-            readableFrameIndex.store(writeFrameIndex, std::memory_order_release);
-            writeFrameIndex = oldReadable;
+            std::lock_guard<std::mutex> lock(layer.slotMutexes[layerSlot]);
+            const float* output = layer.engine->render(layerSlot, layerJob.seq, layerJob.input.data(),
+                                                       layerJob.seedX, layerJob.seedY);
+            layerJob.rendered = output != nullptr;
+            if (output) {
+                std::copy(output, output + layer.frameSize, layerJob.output.begin());
+            }
         }
+        layer.lastCostMicros.store(duration<float, std::micro>(steady_clock::now() - start).count(),
+                                   std::memory_order_relaxed);
+        layer.costSamples.fetch_add(1, std::memory_order_release);
+    }
 
-        // Mark inference as complete
-        inferenceRunning.store(false, std::memory_order_release);
+    publishFrame(job.seq, renderPrimary(slot, job.seq, job.input.data(), job.seedX, job.seedY), job.due, &job);
+
+    // Dropped layers are released once no frame holds them
+    for (int j = 0; j < job.numLayerJobs; j++) {
+        job.layerJobs[j].layer.reset();
     }
-    catch (const std::exception& e) {
-        std::cerr << "Autolume: Inference error: " << e.what() << std::endl;
-        // Mark inference as complete even on error
-        inferenceRunning.store(false, std::memory_order_release);
+    job.numLayerJobs = 0;
+}
+
+void Autolume::adoptLayerFrames(FrameJob& job) {
+    std::lock_guard<std::mutex> lock(layerMutex);
+    for (int j = 0; j < job.numLayerJobs; j++) {
+        auto& layerJob = job.layerJobs[j];
+        if (!layerJob.rendered) {
+            continue;
+        }
+        // Equal sizes, so the job keeps a buffer of the right size
+        std::swap(layerJob.layer->frame, layerJob.output);
+        layerJob.layer->hasFrame = true;
     }
 }
 
-bool Autolume::getLatestFrame(uint8_t* dest, size_t numBytes) {
-    // Don't access frame buffers until initialization is complete
+const float* Autolume::compositeLayers(const float* output) {
+    std::lock_guard<std::mutex> lock(layerMutex);
+
+    const float* frame = output;
+    for (const auto& layer : layers) {
+        if (!layer->hasFrame) {
+            continue;
+        }
+        if (frame == output) {
+            std::copy(output, output + compositeBuf.size(), compositeBuf.begin());
+            frame = compositeBuf.data();
+        }
+        // Blending is per value, so bands of the flat frame are independent
+        const auto& settings = layer->settings;
+        const float* layerFrame = layer->frame.data();
+        taskPool.parallelFor(static_cast<int>(compositeBuf.size()), 64 * 1024, [&](int begin, int end) {
+            LayerCompositor::blend(compositeBuf.data() + begin, layerFrame + begin, compositeScratch.data() + begin,
+                                   static_cast<size_t>(end - begin), settings.blendMode, settings.opacity);
+        });
+    }
+    return frame;
+}
+
+void Autolume::buildSizedFrames(const float* frame, int width, int height, FrameSlot& slot) {
+    // Sizes subscribed now; the native size is served from the RGB copy
+    pyramidTargets.clear();
+    {
+        std::lock_guard<std::mutex> lock(sizeMutex);
+        for (const auto& subscription : sizeSubscriptions) {
+            if (!(subscription.size == FrameSize{width, height})) {
+                pyramidTargets.push_back(subscription.size);
+            }
+        }
+    }
+
+    const size_t numTargets = pyramidTargets.size();
+    for (size_t t = numTargets; t < slot.sized.size(); t++) {
+        sizedFrameBytes.fetch_sub(slot.sized[t].rgb.sizeInBytes(), std::memory_order_relaxed);
+    }
+    slot.sized.resize(numTargets);
+
+    int depth = 0;
+    int totalRows = 0;
+    for (size_t t = 0; t < numTargets; t++) {
+        const FrameSize size = pyramidTargets[t];
+        auto& sized = slot.sized[t];
+        const size_t numBytes = static_cast<size_t>(size.width) * size.height * Constants::frameNumCh;
+        if (sized.rgb.size() != numBytes) {
+            sizedFrameBytes.fetch_sub(sized.rgb.sizeInBytes(), std::memory_order_relaxed);
+            sized.rgb.allocate(numBytes);
+            sizedFrameBytes.fetch_add(sized.rgb.sizeInBytes(), std::memory_order_relaxed);
+        }
+        sized.size = size;
+        depth = std::max(depth, FrameKernels::getPyramidDepth(width, height, size.width, size.height));
+        totalRows += size.height;
+    }
+    if (numTargets == 0) {
+        return;
+    }
+
+    // Build each level the deepest target needs once, halving the one
+    // above in row bands on the pool
+    if (static_cast<int>(pyramidLevels.size()) < depth) {
+        pyramidLevels.resize(depth);
+    }
+    const float* level = frame;
+    int levelWidth = width;
+    int levelHeight = height;
+    for (int k = 1; k <= depth; k++) {
+        const int halfWidth = FrameKernels::getHalfSize(levelWidth);
+        const int halfHeight = FrameKernels::getHalfSize(levelHeight);
+        auto& half = pyramidLevels[k - 1];
+        const size_t count = static_cast<size_t>(halfWidth) * halfHeight * Constants::frameNumCh;
+        if (half.size() != count) {
+            sizedFrameBytes.fetch_sub(half.sizeInBytes(), std::memory_order_relaxed);
+            half.allocate(count);
+            sizedFrameBytes.fetch_add(half.sizeInBytes(), std::memory_order_relaxed);
+        }
+        taskPool.parallelFor(halfHeight, 32, [&](int begin, int end) {
+            FrameKernels::downsample2x(level, levelWidth, levelHeight, half.data(), begin, end);
+        });
+        level = half.data();
+        levelWidth = halfWidth;
+        levelHeight = halfHeight;
+    }
+
+    // Resample every target from the smallest level that covers it. The
+    // targets' rows are one range, so small sizes share bands with large.
+    taskPool.parallelFor(totalRows, 16, [&](int begin, int end) {
+        int firstRow = 0;
+        for (size_t t = 0; t < numTargets && firstRow < end; t++) {
+            const FrameSize size = pyramidTargets[t];
+            const int rowBegin = std::max(begin, firstRow) - firstRow;
+            const int rowEnd = std::min(end, firstRow + size.height) - firstRow;
+            firstRow += size.height;
+            if (rowBegin >= rowEnd) {
+                continue;
+            }
+
+            const int k = FrameKernels::getPyramidDepth(width, height, size.width, size.height);
+            int sourceWidth = width;
+            int sourceHeight = height;
+            for (int i = 0; i < k; i++) {
+                sourceWidth = FrameKernels::getHalfSize(sourceWidth);
+                sourceHeight = FrameKernels::getHalfSize(sourceHeight);
+            }
+            const float* source = k == 0 ? frame : pyramidLevels[k - 1].data();
+            FrameKernels::resampleToRgb(source, sourceWidth, sourceHeight, slot.sized[t].rgb.data(),
+                                        size.width, size.height, rowBegin, rowEnd);
+        }
+    });
+}
+
+void Autolume::publishFrame(uint64_t seq, const float* output, std::chrono::steady_clock::time_point due,
+                            FrameJob* job) {
+    using namespace std::chrono;
+
+    // Workers finish out of order; wait until every earlier frame is out
+    std::unique_lock<std::mutex> turn(publishMutex);
+    while (nextPublishSeq != seq) {
+        if (shouldExit.load(std::memory_order_acquire)) {
+            // Leaves this frame counted in framesInFlight and the turn
+            // unadvanced; stopInferenceThread() resets both once the
+            // workers and the dispatcher have joined
+            return;
+        }
+        publishTurn.wait_for(turn, milliseconds(10));
+    }
+
+    // Layer frames change in frame order, so each frame blends the layers
+    // rendered with it, or the latest ones before it
+    if (job) {
+        adoptLayerFrames(*job);
+    }
+
+    if (output) {
+        // Convert the planar output to RGB: the kernel interleaves, scales
+        // and clamps in one pass
+        const float* frame = compositeLayers(output);
+        const int width = getFrameWidth();
+        const int height = getFrameHeight();
+        auto& slot = frameBuffers[writeFrameIndex];
+        FrameKernels::planarToRgb(frame, slot.rgb.data(), width, height);
+
+        // YUV for subscribed sinks, converted in row-pair bands on the pool.
+        // The slot is the writer's alone until it is queued below.
+        for (int layout = 0; layout < numYuvLayouts; layout++) {
+            slot.hasYuv[layout] = yuvSubscribers[layout].load(std::memory_order_relaxed) > 0;
+            if (!slot.hasYuv[layout]) {
+                continue;
+            }
+            if (slot.yuv[layout].size() != getYuvFrameBytes()) {
+                yuvFrameBytes.fetch_sub(slot.yuv[layout].sizeInBytes(), std::memory_order_relaxed);
+                slot.yuv[layout].allocate(getYuvFrameBytes());
+                yuvFrameBytes.fetch_add(slot.yuv[layout].sizeInBytes(), std::memory_order_relaxed);
+            }
+            uint8_t* yuv = slot.yuv[layout].data();
+            taskPool.parallelFor(FrameKernels::getYuv420RowPairs(height), 16, [&](int begin, int end) {
+                FrameKernels::planarToYuv420(frame, yuv, width, height, static_cast<YuvLayout>(layout), begin, end);
+            });
+        }
+        buildSizedFrames(frame, width, height, slot);
+
+        // Queue it for the GUI and take a free buffer for the next frame
+        std::lock_guard<std::mutex> lock(frameMutex);
+        queuedFrames.push_back({writeFrameIndex, due});
+        if (freeFrameBuffers.empty()) {
+            // Every buffer is waiting: drop the oldest frame, never the newest
+            freeFrameBuffers.push_back(queuedFrames.front().buffer);
+            queuedFrames.erase(queuedFrames.begin());
+        }
+        writeFrameIndex = freeFrameBuffers.back();
+        freeFrameBuffers.pop_back();
+    }
+
+    nextPublishSeq++;
+    work.framesInFlight.fetch_sub(1, std::memory_order_acq_rel);
+    turn.unlock();
+    publishTurn.notify_all();
+}
+
+void Autolume::extractFeatures() {
+    std::lock_guard<std::mutex> lock(featureMutex);
+
+    // Copy every hop queued since the last frame (lock-free read from audio
+    // thread). Without a new hop the previous history is analysed again.
+    const int historySize = analysisHistorySize;
+    const float* histories = queuedHistories.data();
+    int numHops = readQueuedHops(queuedHistories.data(), lastHopIndex);
+    if (numHops > 0) {
+        const int64_t ticks = hopTimes[lastHopIndex % Constants::numHopSlots].load(std::memory_order_relaxed);
+        analysedHopTime = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(ticks));
+        const float* newest = histories + static_cast<size_t>(numHops - 1) * Constants::max_nfft;
+        std::copy(newest, newest + historySize, analysisHistory.begin());
+    } else {
+        histories = analysisHistory.data();
+        numHops = 1;
+    }
+
+    float* features = inference_input_buf.data();
+    int offset = 0;
+    float totalCost = 0.0f;
+    for (auto& extractor : featureChain) {
+        extractor->processTimed(histories, Constants::max_nfft, numHops, historySize, lastHopIndex, features + offset);
+        offset += extractor->getNumFeatures();
+        totalCost += extractor->getAverageCostMicros();
+    }
+
+    // Publish only the local features; subscribed streams follow them
+    if (busPublication) {
+        busPublication->publish(features, offset);
+    }
+    for (auto& subscription : busSubscriptions) {
+        // Nothing before the publisher's first write, or after a read that
+        // kept colliding with it: the slice keeps its last values
+        const int count = subscription.channel->read(busScratch.data(), busSliceSize);
+        reportBusTruncation(subscription);
+        if (count > 0) {
+            std::copy(busScratch.data(), busScratch.data() + count, subscription.values.begin());
+            std::fill(subscription.values.begin() + count, subscription.values.end(), 0.0f);
+        }
+        std::copy(subscription.values.begin(), subscription.values.end(), features + offset);
+        offset += busSliceSize;
+    }
+
+    // Unused tail of the model input stays zero
+    std::fill(features + offset, features + config.nfft, 0.0f);
+
+    infer.analysisCostMicros.store(totalCost, std::memory_order_relaxed);
+}
+
+bool Autolume::verifyFeatureAccuracy(const PipelineConfig& newConfig) {
+    const int length = Constants::max_nfft;
+    const double sampleRate = newConfig.targetSampleRate;
+
+    // Fixed test signals: tones off the bin grid over light noise, an
+    // impulse train, and white noise
+    std::vector<std::vector<double>> signals(3, std::vector<double>(length));
+    std::mt19937 rng(1234);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    for (int n = 0; n < length; n++) {
+        double t = n / sampleRate;
+        signals[0][n] = 0.5 * std::sin(2.0 * M_PI * 440.0 * t) + 0.25 * std::sin(2.0 * M_PI * 1250.5 * t)
+                      + 0.1 * std::sin(2.0 * M_PI * 0.3 * sampleRate * t) + 0.01 * normal(rng);
+        signals[1][n] = (n % 97 == 0) ? 1.0 : 0.0;
+        signals[2][n] = 0.3 * normal(rng);
+    }
+
+    // A private copy of the chain, so the live extractors' state (cached
+    // hops, filter memories) is untouched; its bank stages read idle banks
+    auto envelopes = std::make_unique<BandEnvelopeFilterbank<Constants::numEnvelopeBands>>();
+    auto sliding = std::make_unique<SlidingDftBank>();
+    envelopes->prepare(sampleRate);
+    sliding->prepare(sampleRate, newConfig.nfft);
+    vector<unique_ptr<FeatureExtractor>> chain = makeFeatureChain(newConfig, *envelopes, *sliding);
+    const AnalysisContext context = makeAnalysisContext(newConfig);
+    for (auto& extractor : chain) {
+        extractor->prepare(context);
+    }
+
+    bool allPassed = true;
+    std::vector<float> history(length);
+    std::vector<float> features(Constants::max_nfft);
+    std::vector<double> reference(Constants::max_nfft);
+    for (size_t e = 0; e < chain.size(); e++) {
+        auto& extractor = chain[e];
+        const int count = extractor->getNumFeatures();
+
+        AccuracyMetrics::Report report;
+        bool hasReference = true;
+        double range = 0.0;
+        for (const auto& signal : signals) {
+            if (!extractor->computeReference(signal.data(), length, reference.data())) {
+                hasReference = false;
+                break;
+            }
+            std::transform(signal.begin(), signal.end(), history.begin(),
+                           [](double v) { return static_cast<float>(v); });
+            extractor->process(history.data(), length, 0, features.data());
+
+            double signalRange = 1e-12;
+            for (int i = 0; i < count; i++) {
+                signalRange = std::max(signalRange, std::abs(reference[i]));
+            }
+            range = std::max(range, signalRange);
+            report = AccuracyMetrics::worst(report, AccuracyMetrics::compareSignals(
+                features.data(), reference.data(), static_cast<size_t>(count), signalRange));
+        }
+
+        if (!hasReference) {
+            std::cout << "Autolume: Feature stage " << e << " has no double-precision reference" << std::endl;
+            continue;
+        }
+
+        // Float32 analysis should sit near single-precision rounding
+        const AccuracyMetrics::Thresholds thresholds{90.0, 0.0, 1e-4 * range};
+        bool passed = AccuracyMetrics::passes(report, thresholds);
+        allPassed = allPassed && passed;
+        std::cout << "Autolume: Feature stage " << e << " vs double: PSNR " << report.psnr
+                  << " dB, max error " << report.maxError << (passed ? "" : " (FAILED)") << std::endl;
+    }
+    return allPassed;
+}
+
+bool Autolume::verifyFrameKernels() {
+    // Kernel bytes round the exact value: at most half a code value off
+    constexpr AccuracyMetrics::Thresholds thresholds{55.0, 0.0, 0.5 + 1e-3};
+    constexpr int sizes[][2] = {{64, 48}, {33, 17}};
+
+    // Slightly past [-1, 1], as model outputs can be, to reach the clamps
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> uniform(-1.1f, 1.1f);
+
+    bool allPassed = true;
+    for (const auto& size : sizes) {
+        const int width = size[0];
+        const int height = size[1];
+        std::vector<float> frame(static_cast<size_t>(width) * height * Constants::frameNumCh);
+        for (auto& value : frame) {
+            value = uniform(rng);
+        }
+
+        const size_t bytes = FrameKernels::getYuv420Bytes(width, height);
+        std::vector<uint8_t> yuv(bytes);
+        std::vector<float> converted(bytes);
+        std::vector<double> reference(bytes);
+        for (YuvLayout layout : {YuvLayout::Nv12, YuvLayout::I420}) {
+            // Two bands, split where the worker pool would split a frame
+            const int numPairs = FrameKernels::getYuv420RowPairs(height);
+            FrameKernels::planarToYuv420(frame.data(), yuv.data(), width, height, layout, 0, numPairs / 2);
+            FrameKernels::planarToYuv420(frame.data(), yuv.data(), width, height, layout, numPairs / 2, numPairs);
+            FrameKernels::referenceYuv420(frame.data(), reference.data(), width, height, layout);
+            std::copy(yuv.begin(), yuv.end(), converted.begin());
+
+            const auto report = AccuracyMetrics::compareSignals(converted.data(), reference.data(), bytes, 255.0);
+            const bool passed = AccuracyMetrics::passes(report, thresholds);
+            allPassed = allPassed && passed;
+            std::cout << "Autolume: YUV 4:2:0 " << (layout == YuvLayout::Nv12 ? "NV12 " : "I420 ") << width << "x"
+                      << height << " vs BT.709: PSNR " << report.psnr << " dB, max error " << report.maxError
+                      << (passed ? "" : " (FAILED)") << std::endl;
+        }
+    }
+    return allPassed;
+}
+
+void Autolume::advanceShownFrame() {
+    // Show the newest frame whose audio is being heard; earlier due frames
+    // are skipped, later ones keep waiting
+    const auto now = std::chrono::steady_clock::now();
+    while (!queuedFrames.empty() && queuedFrames.front().due <= now) {
+        freeFrameBuffers.push_back(shownFrameBuffer);
+        shownFrameBuffer = queuedFrames.front().buffer;
+        queuedFrames.erase(queuedFrames.begin());
+    }
+}
+
+void Autolume::subscribeYuv(YuvLayout layout) {
+    yuvSubscribers[static_cast<int>(layout)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Autolume::unsubscribeYuv(YuvLayout layout) {
+    yuvSubscribers[static_cast<int>(layout)].fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool Autolume::getLatestYuvFrame(YuvLayout layout, uint8_t* dest, size_t numBytes) {
     if (!isInitialized.load(std::memory_order_acquire)) {
         return false;
     }
 
-    if (numBytes < Constants::frameBytes) {
+    std::lock_guard<std::mutex> lock(frameMutex);
+    advanceShownFrame();
+
+    const auto& slot = frameBuffers[shownFrameBuffer];
+    const auto& readable = slot.yuv[static_cast<int>(layout)];
+    if (!slot.hasYuv[static_cast<int>(layout)] || numBytes < readable.size()) {
         return false;
     }
+    std::copy(readable.begin(), readable.end(), dest);
+    return true;
+}
 
-    // Read from the readable buffer
-    int readIdx;
-    {
-        std::lock_guard<std::mutex> lock(frameMutex);
-        readIdx = readableFrameIndex.load(std::memory_order_acquire);
+bool Autolume::subscribeSize(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return false;
     }
 
-    // Copy frame data
-    std::copy(frameBuffer[readIdx].begin(), frameBuffer[readIdx].end(), dest);
+    std::lock_guard<std::mutex> lock(sizeMutex);
+    for (auto& subscription : sizeSubscriptions) {
+        if (subscription.size == FrameSize{width, height}) {
+            subscription.subscribers++;
+            return true;
+        }
+    }
+    sizeSubscriptions.push_back({{width, height}, 1});
     return true;
 }
 
-void Autolume::findNoiseStrengthParameters() {
-    // Find all parameters with "noise_strength" in their name
-    noiseStrengthParams.clear();
+void Autolume::unsubscribeSize(int width, int height) {
+    std::lock_guard<std::mutex> lock(sizeMutex);
+    for (auto it = sizeSubscriptions.begin(); it != sizeSubscriptions.end(); ++it) {
+        if (it->size == FrameSize{width, height}) {
+            if (--it->subscribers == 0) {
+                sizeSubscriptions.erase(it);
+            }
+            return;
+        }
+    }
+}
+
+bool Autolume::getLatestFrame(int width, int height, uint8_t* dest, size_t numBytes) {
+    if (!isInitialized.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(frameMutex);
+    advanceShownFrame();
 
-    for (const auto& param : model.named_parameters()) {
-        if (param.name.find("noise_strength") != std::string::npos) {
-            noiseStrengthParams.push_back(param.value);
-            std::cout << "Autolume: Found noise_strength parameter: " << param.name << std::endl;
+    const auto& slot = frameBuffers[shownFrameBuffer];
+    const FrameSize size{width, height};
+    for (const auto& sized : slot.sized) {
+        if (sized.size == size) {
+            if (numBytes < sized.rgb.size()) {
+                return false;
+            }
+            std::copy(sized.rgb.begin(), sized.rgb.end(), dest);
+            return true;
         }
     }
 
-    std::cout << "Autolume: Cached " << noiseStrengthParams.size()
-              << " noise_strength parameters" << std::endl;
+    // The native size is the RGB copy itself
+    const size_t nativeBytes = static_cast<size_t>(width) * height * Constants::frameNumCh;
+    if (!(size == FrameSize{getFrameWidth(), getFrameHeight()}) || slot.rgb.size() != nativeBytes
+        || numBytes < nativeBytes) {
+        return false;
+    }
+    std::copy(slot.rgb.begin(), slot.rgb.end(), dest);
+    return true;
 }
 
-void Autolume::setNoiseStrength(float value) {
-    // Set all noise_strength parameters to the given value
-    // Thread-safe: PyTorch tensor operations are thread-safe
-    torch::NoGradGuard no_grad;
+bool Autolume::getLatestFrame(uint8_t* dest, size_t numBytes) {
+    // Don't access frame buffers until initialization is complete
+    if (!isInitialized.load(std::memory_order_acquire)) {
+        return false;
+    }
 
-    for (auto& param : noiseStrengthParams) {
-        param.fill_(value);
+    // Copy under the lock: the buffers are reallocated when a model with a
+    // different frame size is loaded
+    std::lock_guard<std::mutex> lock(frameMutex);
+
+    advanceShownFrame();
+
+    const auto& readable = frameBuffers[shownFrameBuffer].rgb;
+    if (numBytes < readable.size()) {
+        return false;
     }
+
+    // Copy frame data
+    std::copy(readable.begin(), readable.end(), dest);
+    return true;
 }
 
-float Autolume::getNoiseStrength() const {
-    // Return the value of the first noise_strength parameter
-    if (noiseStrengthParams.empty()) {
-        return 0.0f;
+void Autolume::setNoiseStrength(float value) {
+    // No engine yet means no model to apply it to
+    if (engine) {
+        engine->setNoiseStrength(value);
     }
-
-    return noiseStrengthParams[0].item<float>();
+}
+float Autolume::getNoiseStrength() const {
+    return engine ? engine->getNoiseStrength() : 0.0f;
 }
 
+bool Autolume::canSetNoiseStrength() const {
+    return engine && modelLoaded.load(std::memory_order_acquire) && engine->canSetNoiseStrength();
+}
 void Autolume::setLatentSpeed(float value) {
-    latentSpeed.store(value, std::memory_order_release);
+    gui.latentSpeed.store(value, std::memory_order_release);
 }
 
 float Autolume::getLatentSpeed() const {
-    return latentSpeed.load(std::memory_order_acquire);
+    return gui.latentSpeed.load(std::memory_order_acquire);
 }